@@ -1,37 +1,64 @@
+#include <algorithm>
 #include <cstdlib>
 #include <elementary_visualizer/elementary_visualizer.hpp>
 #include <framework.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <grid_surface.hpp>
 #include <iostream>
+#include <map>
+#include <utility>
 
 namespace ev = elementary_visualizer;
 
-ev::SurfaceData
-    field_to_surface_data(const size_t width, const std::vector<float> &field)
+// Flat grid of a square field of `width` cells per row, the first row
+// at the top.
+GridSurface field_grid(const size_t width)
 {
-    std::vector<ev::Vertex> vertices(field.size());
-
-    for (size_t i = 0; i < field.size(); ++i)
+    std::vector<glm::vec3> positions(width * width);
+    std::vector<size_t> sources(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
     {
-        const float v = 1.0f - 0.5f * (0.5f + field[i]);
-        glm::vec4 color(v, v, v, 1.0f);
-
         size_t u = i % width;
         float x = 2.0f * static_cast<float>(u) / (width - 1) - 1.0f;
         float y =
             -2.0f * static_cast<float>((i - u) / width) / (width - 1) + 1.0f;
-        glm::vec3 position(x, y, 0.0f);
-        vertices[i] = ev::Vertex(position, color);
+        positions[i] = glm::vec3(x, y, 0.0f);
+        sources[i] = i;
     }
 
-    return ev::SurfaceData(vertices, width, ev::SurfaceMode::flat);
+    return GridSurface(
+        std::move(positions), std::move(sources), width, ev::SurfaceMode::flat
+    );
 }
 
-std::vector<float> iterate_field(
-    const size_t width,
-    std::vector<float> field,
-    std::vector<float> previous_field
-)
+glm::vec4 field_color(const float value)
+{
+    const float v = 1.0f - 0.5f * (0.5f + value);
+    return glm::vec4(v, v, v, 1.0f);
+}
+
+// Leapfrog update of one cell from its neighbours.
+struct Leapfrog
+{
+    float operator()(
+        const float center,
+        const float x_minus_dx,
+        const float x_plus_dx,
+        const float y_minus_dy,
+        const float y_plus_dy,
+        const float previous
+    ) const
+    {
+        return this->rx_sq * (x_minus_dx + x_plus_dx) +
+               this->ry_sq * (y_minus_dy + y_plus_dy) +
+               2.0f * (1.0f - this->rx_sq - this->ry_sq) * center - previous;
+    }
+
+    float rx_sq;
+    float ry_sq;
+};
+
+Leapfrog leapfrog()
 {
     const float c = 1.0f;
     const float dt = 0.001f;
@@ -44,6 +71,17 @@ std::vector<float> iterate_field(
     const float ry = c * dt / dy;
     const float ry_sq = ry * ry;
 
+    return Leapfrog{rx_sq, ry_sq};
+}
+
+std::vector<float> iterate_field(
+    const size_t width,
+    std::vector<float> field,
+    std::vector<float> previous_field
+)
+{
+    const Leapfrog update = leapfrog();
+
     const int iwidth = width;
 
     std::vector<float> new_field = std::vector<float>(width * width);
@@ -56,22 +94,241 @@ std::vector<float> iterate_field(
             const int y_minus_dy = (y == 0) ? (iwidth - 1) : (y - 1);
             const int y_plus_dy = (y == (iwidth - 1)) ? 0 : (y + 1);
 
-            new_field[y * iwidth + x] =
-                rx_sq * (field[y * iwidth + x_minus_dx] +
-                         field[y * iwidth + x_plus_dx]) +
-                ry_sq * (field[y_minus_dy * iwidth + x] +
-                         field[y_plus_dy * iwidth + x]) +
-                2.0f * (1.0f - rx_sq - ry_sq) * field[y * iwidth + x] -
-                previous_field[y * iwidth + x];
+            new_field[y * iwidth + x] = update(
+                field[y * iwidth + x],
+                field[y * iwidth + x_minus_dx],
+                field[y * iwidth + x_plus_dx],
+                field[y_minus_dy * iwidth + x],
+                field[y_plus_dy * iwidth + x],
+                previous_field[y * iwidth + x]
+            );
         }
     }
 
     return new_field;
 }
 
+// Advances the field by `steps` iterations with temporal blocking;
+// instead of sweeping the whole grid once per iteration, the grid is
+// split into tiles, and each tile is advanced by all of the iterations
+// while it stays in the cache. The tiles are copied with a halo of
+// `steps` cells, wrapped around the periodic edges, which shrinks
+// by one cell per iteration, so the tiles are independent and
+// the result is identical to calling `iterate_field` `steps` times.
+void iterate_field_blocked(
+    const size_t width,
+    const int steps,
+    std::vector<float> &field,
+    std::vector<float> &previous_field
+)
+{
+    // Two tiles with halos fit into the L2 cache.
+    const int tile_size = 128;
+
+    const Leapfrog update = leapfrog();
+
+    const int iwidth = width;
+    auto wrap = [iwidth](int i)
+    {
+        i %= iwidth;
+        return (i < 0) ? (i + iwidth) : i;
+    };
+
+    std::vector<float> new_field(width * width);
+    std::vector<float> new_previous_field(width * width);
+    const int local_size = tile_size + 2 * steps;
+    std::vector<float> current(local_size * local_size);
+    std::vector<float> previous(local_size * local_size);
+
+    for (int tile_y = 0; tile_y < iwidth; tile_y += tile_size)
+    {
+        for (int tile_x = 0; tile_x < iwidth; tile_x += tile_size)
+        {
+            const int size_x = std::min(tile_size, iwidth - tile_x);
+            const int size_y = std::min(tile_size, iwidth - tile_y);
+            const int local_x = size_x + 2 * steps;
+            const int local_y = size_y + 2 * steps;
+
+            for (int y = 0; y != local_y; ++y)
+            {
+                const int row = wrap(tile_y - steps + y) * iwidth;
+                for (int x = 0; x != local_x; ++x)
+                {
+                    const int i = row + wrap(tile_x - steps + x);
+                    current[y * local_x + x] = field[i];
+                    previous[y * local_x + x] = previous_field[i];
+                }
+            }
+
+            // The new values overwrite the previous ones in place,
+            // then the two buffers swap roles.
+            float *current_data = current.data();
+            float *previous_data = previous.data();
+            for (int step = 1; step <= steps; ++step)
+            {
+                for (int y = step; y != local_y - step; ++y)
+                {
+                    const float *row = current_data + y * local_x;
+                    float *previous_row = previous_data + y * local_x;
+                    for (int x = step; x != local_x - step; ++x)
+                    {
+                        previous_row[x] = update(
+                            row[x],
+                            row[x - 1],
+                            row[x + 1],
+                            row[x - local_x],
+                            row[x + local_x],
+                            previous_row[x]
+                        );
+                    }
+                }
+                std::swap(current_data, previous_data);
+            }
+
+            for (int y = 0; y != size_y; ++y)
+            {
+                const int row = (tile_y + y) * iwidth + tile_x;
+                const int local_row = (steps + y) * local_x + steps;
+                for (int x = 0; x != size_x; ++x)
+                {
+                    new_field[row + x] = current_data[local_row + x];
+                    new_previous_field[row + x] = previous_data[local_row + x];
+                }
+            }
+        }
+    }
+
+    field = std::move(new_field);
+    previous_field = std::move(new_previous_field);
+}
+
+// Plays the simulation back keeping only its two current time levels.
+// The leapfrog update is reversible, the previous level follows from
+// the current two levels, so moving the slider backwards steps
+// the solver backwards instead of reading stored frames. Rounding
+// makes the backward steps inexact; the levels of every
+// `checkpoint_interval`th frame are kept when first reached forwards,
+// and restored whenever the playback passes them, which bounds
+// the drift.
+class Playback
+{
+public:
+
+    Playback(
+        const size_t width,
+        const int steps_per_frame,
+        const bool temporal_blocking,
+        const int checkpoint_interval,
+        std::vector<float> current_field,
+        std::vector<float> previous_field
+    )
+        : width(width),
+          steps_per_frame(steps_per_frame),
+          temporal_blocking(temporal_blocking),
+          checkpoint_interval(checkpoint_interval),
+          levels{std::move(current_field), std::move(previous_field)},
+          frame(0),
+          exact(true)
+    {
+        this->checkpoints.emplace(0, this->levels);
+    }
+
+    // Field of the frame, stepped to from the current frame or from
+    // the checkpoint before the frame, whichever takes fewer steps.
+    const std::vector<float> &seek(const int target)
+    {
+        auto checkpoint = this->checkpoints.upper_bound(target);
+        if (checkpoint != this->checkpoints.begin())
+        {
+            --checkpoint;
+            if (target - checkpoint->first < std::abs(target - this->frame))
+            {
+                this->levels = checkpoint->second;
+                this->frame = checkpoint->first;
+                this->exact = true;
+            }
+        }
+
+        while (this->frame < target)
+            this->advance(false);
+        while (this->frame > target)
+            this->advance(true);
+        return this->levels.current;
+    }
+
+private:
+
+    struct Levels
+    {
+        std::vector<float> current;
+        std::vector<float> previous;
+    };
+
+    // Steps by one frame. Backwards, the current level takes the role
+    // of the previous one, so the same update gives the level before
+    // the previous one.
+    void advance(const bool backwards)
+    {
+        std::vector<float> &current =
+            backwards ? this->levels.previous : this->levels.current;
+        std::vector<float> &previous =
+            backwards ? this->levels.current : this->levels.previous;
+        if (this->temporal_blocking)
+        {
+            iterate_field_blocked(
+                this->width, this->steps_per_frame, current, previous
+            );
+        }
+        else
+        {
+            for (int step = 0; step != this->steps_per_frame; ++step)
+            {
+                std::vector<float> new_field =
+                    iterate_field(this->width, current, previous);
+                previous = std::move(current);
+                current = std::move(new_field);
+            }
+        }
+        this->frame += backwards ? -1 : 1;
+        this->exact = this->exact && !backwards;
+
+        if (this->frame % this->checkpoint_interval != 0)
+            return;
+        auto checkpoint = this->checkpoints.find(this->frame);
+        if (checkpoint != this->checkpoints.end())
+        {
+            this->levels = checkpoint->second;
+            this->exact = true;
+        }
+        else if (this->exact)
+        {
+            this->checkpoints.emplace(this->frame, this->levels);
+        }
+    }
+
+    size_t width;
+    int steps_per_frame;
+    bool temporal_blocking;
+    int checkpoint_interval;
+    Levels levels;
+    int frame;
+    // Whether the levels were only stepped forwards from a checkpoint.
+    bool exact;
+    std::map<int, Levels> checkpoints;
+};
+
 int main(int, char **)
 {
     const int frames = 300;
+    // Iterations per frame; the iterations of a frame are temporally
+    // blocked, which pays off on grids larger than the caches. A single
+    // iteration reuses nothing from the tiles, so it is swept plainly.
+    const int steps_per_frame = 1;
+    const bool temporal_blocking = steps_per_frame > 1;
+    // Steps the solver to the frame shown instead of storing all of
+    // the frames, see Playback.
+    const bool reversible_playback = true;
+    const int checkpoint_interval = 25;
 
     const size_t width = 200;
     std::vector<float> current_field(width * width, 0.0f);
@@ -95,18 +352,32 @@ int main(int, char **)
 
     std::vector<float> previous_field = current_field;
 
+    Playback playback(
+        width,
+        steps_per_frame,
+        temporal_blocking,
+        checkpoint_interval,
+        current_field,
+        previous_field
+    );
+
+    GridSurface grid = field_grid(width);
+
+    // Without the reversible playback all of the frames are stored.
     std::vector<ev::SurfaceData> surface_datas;
-    for (int frame = 0; frame != frames; ++frame)
+    if (!reversible_playback)
     {
-        surface_datas.push_back(field_to_surface_data(width, current_field));
-        std::vector<float> new_field =
-            iterate_field(width, current_field, previous_field);
-        previous_field = current_field;
-        current_field = new_field;
+        for (int frame = 0; frame != frames; ++frame)
+        {
+            surface_datas.push_back(
+                grid.surface_data(playback.seek(frame).data(), field_color)
+            );
+        }
     }
 
-    auto surface =
-        ev::SurfaceVisual::create(field_to_surface_data(width, current_field));
+    auto surface = ev::SurfaceVisual::create(
+        grid.surface_data(current_field.data(), field_color)
+    );
     if (!surface)
         return EXIT_FAILURE;
     surface.value()->set_ambient_color(glm::vec3(1.0f));
@@ -136,9 +407,22 @@ int main(int, char **)
         return EXIT_FAILURE;
     framework.value()->add_visual(surface.value());
 
+    int shown_frame = -1;
     int run_result = framework.value()->run(
         [&](const int frame, const int, const float)
-        { surface.value()->set_surface_data(surface_datas[frame]); }
+        {
+            if (!reversible_playback)
+            {
+                surface.value()->set_surface_data(surface_datas[frame]);
+                return;
+            }
+            if (frame == shown_frame)
+                return;
+            surface.value()->set_surface_data(
+                grid.surface_data(playback.seek(frame).data(), field_color)
+            );
+            shown_frame = frame;
+        }
     );
 
     return run_result;
@@ -1,129 +1,27 @@
+#include <algorithm>
+#include <amr.hpp>
+#include <chunks.hpp>
 #include <cstdlib>
+#include <decomposition.hpp>
 #include <elementary_visualizer/elementary_visualizer.hpp>
+#include <field.hpp>
+#include <frame_cache.hpp>
 #include <framework.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <grid_surface.hpp>
 #include <iostream>
+#include <optional>
+#include <progressive.hpp>
+#include <raster.hpp>
+#include <sstream>
+#include <spectral_solver.hpp>
+#include <thread>
+#include <tiling.hpp>
+#include <wave_solver.hpp>
+#include <workers.hpp>
 
 namespace ev = elementary_visualizer;
 
-class Field
-{
-public:
-
-    Field(size_t size_x, size_t size_y)
-        : size(glm::uvec2(size_x, size_y)), field(size_x * size_y)
-    {}
-
-    Field(glm::uvec2 size) : size(size), field(size.x * size.y) {}
-
-    size_t index(const int x, const int y) const
-    {
-        return Field::mod(y, this->size.y) * this->size.x +
-               Field::mod(x, this->size.x);
-    }
-
-    size_t index(const glm::ivec2 &i) const
-    {
-        return index(i.x, i.y);
-    }
-
-    float operator()(const int x, const int y) const
-    {
-        return this->field[this->index(x, y)];
-    }
-
-    float &operator()(const int x, const int y)
-    {
-        return this->field[this->index(x, y)];
-    }
-
-    glm::uvec2 get_size() const
-    {
-        return this->size;
-    }
-
-private:
-
-    static size_t mod(int n, const int m)
-    {
-        n = n % m;
-        if (n < 0)
-            n += m;
-        return static_cast<size_t>(n);
-    }
-
-    glm::uvec2 size;
-    std::vector<float> field;
-};
-
-Field operator*(float c, Field field)
-{
-    const glm::vec2 size = field.get_size();
-    for (size_t x = 0; x != size.x; ++x)
-    {
-        for (size_t y = 0; y < size.y; ++y)
-        {
-            field(x, y) *= c;
-        }
-    }
-    return field;
-}
-
-Field operator+(Field field_0, const Field &field_1)
-{
-    const glm::vec2 size = field_0.get_size();
-    for (size_t x = 0; x != size.x; ++x)
-    {
-        for (size_t y = 0; y < size.y; ++y)
-        {
-            field_0(x, y) += field_1(x, y);
-        }
-    }
-    return field_0;
-}
-
-float interp(
-    float t, float min, float max, float t_min = 0.0f, float t_max = 1.0f
-)
-{
-    t = (t - t_min) / (t_max - t_min);
-    return min + (max - min) * t;
-}
-
-template <typename T>
-T runge_kutta_iteration(
-    const float t, const T &y, std::function<T(float, T)> f, const float h
-)
-{
-    T k_1 = f(t, y);
-    T k_2 = f(t + 0.5f * h, y + (0.5f * h) * k_1);
-    T k_3 = f(t + 0.5f * h, y + (0.5f * h) * k_2);
-    T k_4 = f(t + h, y + h * k_3);
-    return y + (h / 6.0f) * (k_1 + 2.0f * k_2 + 2.0f * k_3 + k_4);
-}
-
-struct FieldState
-{
-    FieldState(const Field &amp, const Field &vel) : amp(amp), vel(vel) {}
-
-    Field amp;
-    Field vel;
-};
-
-FieldState operator*(float c, const FieldState &field_state)
-{
-    return FieldState(c * field_state.amp, c * field_state.vel);
-}
-
-FieldState
-    operator+(const FieldState &field_state_0, const FieldState &field_state_1)
-{
-    return FieldState(
-        field_state_0.amp + field_state_1.amp,
-        field_state_0.vel + field_state_1.vel
-    );
-}
-
 const std::vector<std::pair<float, glm::vec4>> &colormap_amplitude()
 {
     static std::vector<std::pair<float, glm::vec4>> colormap = {
@@ -150,139 +48,188 @@ const std::vector<std::pair<float, glm::vec4>> &colormap_energy()
     return colormap;
 }
 
-glm::vec4
-    to_color(float v, const std::vector<std::pair<float, glm::vec4>> &colormap)
+template <typename T>
+float cell_energy(
+    const FieldState<T> &field_state,
+    const WaveParameters &parameters,
+    const int x,
+    const int y
+)
 {
-    if (v < colormap[0].first)
-        return colormap[0].second;
-    if (v > colormap.back().first)
-        return colormap.back().second;
-
-    std::optional<std::pair<float, glm::vec4>> color_begin;
-    std::optional<std::pair<float, glm::vec4>> color_end;
-    for (const auto &color_value : colormap)
-    {
-        if (color_value.first <= v)
-        {
-            color_begin = color_value;
-        }
-        else if (!color_end)
-        {
-            color_end = color_value;
-            break;
-        }
-    }
-
-    if (color_begin && color_end)
-    {
-        return glm::vec4(
-            interp(
-                v,
-                color_begin->second.r,
-                color_end->second.r,
-                color_begin->first,
-                color_end->first
-            ),
-            interp(
-                v,
-                color_begin->second.g,
-                color_end->second.g,
-                color_begin->first,
-                color_end->first
-            ),
-            interp(
-                v,
-                color_begin->second.b,
-                color_end->second.b,
-                color_begin->first,
-                color_end->first
-            ),
-            interp(
-                v,
-                color_begin->second.a,
-                color_end->second.a,
-                color_begin->first,
-                color_end->first
-            )
-        );
-    }
-
-    return glm::vec4();
+    const float c = parameters.c;
+    const float dx = parameters.dx;
+    const float dy = parameters.dy;
+    const float dadx =
+        (field_state.amp(x + 1, y) - field_state.amp(x - 1, y)) / (2 * dx);
+    const float dady =
+        (field_state.amp(x, y + 1) - field_state.amp(x, y - 1)) / (2 * dy);
+    return 0.5f * (field_state.vel(x, y) * field_state.vel(x, y) +
+                   c * c * (dadx * dadx + dady * dady));
 }
 
-ev::SurfaceData
-    field_state_to_surface_data(const FieldState &field_state, bool show_energy)
+// Grid of the field of `size`, which spans [-1, +1] and is repeated
+// periodically along x as far as [-view_extent, +view_extent].
+GridSurface periodic_grid(const glm::uvec2 size, const float view_extent)
 {
-    const glm::uvec2 size(field_state.amp.get_size());
-    std::vector<ev::Vertex> vertices(size.x * size.y);
+    std::vector<glm::vec3> tile(size.x * size.y);
     for (size_t x = 0; x != size.x; ++x)
     {
         for (size_t y = 0; y < size.y; ++y)
         {
-            glm::vec4 color;
-            if (show_energy)
-            {
-                const float c = 1.0f;
-                const float dx = 0.005f;
-                const float dy = dx;
-                const float dadx =
-                    (field_state.amp(x + 1, y) - field_state.amp(x - 1, y)) /
-                    (2 * dx);
-                const float dady =
-                    (field_state.amp(x, y + 1) - field_state.amp(x, y - 1)) /
-                    (2 * dy);
-                const float energy =
-                    0.5f * (field_state.vel(x, y) * field_state.vel(x, y) +
-                            c * c * (dadx * dadx + dady * dady));
-                color = to_color(energy, colormap_energy());
-            }
-            else
-            {
-                color = to_color(field_state.amp(x, y), colormap_amplitude());
-            }
-
             float fx = 2.0f * static_cast<float>(x) / (size.x - 1) - 1.0f;
             float fy = 2.0f * static_cast<float>(y) / (size.y - 1) - 1.0f;
-            glm::vec3 position(fx, fy, 0.0f);
-            vertices[field_state.amp.index(x, y)] = ev::Vertex(position, color);
+            tile[y * size.x + x] = glm::vec3(fx, fy, 0.0f);
         }
     }
 
-    return ev::SurfaceData(vertices, size.x, ev::SurfaceMode::smooth);
+    return tile_grid(
+        tile, size.x, -view_extent, view_extent, ev::SurfaceMode::smooth
+    );
+}
+
+// Energy density of every cell.
+template <typename T>
+Field<float> energy_field(
+    const FieldState<T> &field_state, const WaveParameters &parameters
+)
+{
+    const glm::uvec2 size(field_state.amp.get_size());
+    Field<float> energy(size);
+    for (size_t y = 0; y != size.y; ++y)
+    {
+        for (size_t x = 0; x != size.x; ++x)
+            energy(x, y) = cell_energy(field_state, parameters, x, y);
+    }
+    return energy;
+}
+
+// Surface data of the energy density or the amplitude of the field,
+// on the grid of its size.
+template <typename T>
+ev::SurfaceData field_state_to_surface_data(
+    GridSurface &grid,
+    const FieldState<T> &field_state,
+    const WaveParameters &parameters,
+    const bool show_energy,
+    const ColorTable &colors
+)
+{
+    auto color = [&](const float value) { return colors.color(value); };
+    if (show_energy)
+        return grid.surface_data(
+            energy_field(field_state, parameters).data(), color
+        );
+    return grid.surface_data(field_state.amp.data(), color);
 }
 
-FieldState iterate_field(const float, const FieldState &state)
+WaveParameters wave_parameters()
 {
     const float c = 1.0f;
     const float dx = 0.005f;
-    const float rx = c * c / (dx * dx);
     const float dy = dx;
-    const float ry = c * c / (dy * dy);
+    return WaveParameters{c, dx, dy};
+}
 
-    const glm::uvec2 size(state.amp.get_size());
-    Field acc(state.amp.get_size());
+// Laplacian stencil of both solvers; the higher order stencils keep
+// the waves accurate on coarser grids.
+using Stencil = SecondOrder;
 
-    for (size_t x = 0; x != size.x; ++x)
-    {
-        for (size_t y = 0; y != size.y; ++y)
-        {
-            acc(x, y) = rx * (state.amp(x - 1, y) + state.amp(x + 1, y)) +
-                        ry * (state.amp(x, y - 1) + state.amp(x, y + 1)) -
-                        2.0f * (rx + ry) * state.amp(x, y);
-        }
-    }
+// Storage precision of the fields of the finite difference solver,
+// see Field. The accelerations of this grid overflow Half, BFloat16
+// halves the memory traffic. The spectral solver always uses float.
+using Real = float;
 
-    return FieldState(state.vel, acc);
+// Iteration of the strip of the rows simulated by this process.
+FieldState<Real> iterate_field(
+    const FieldState<Real> &state, Decomposition &decomposition
+)
+{
+    return decomposed_wave_iteration<
+        Boundaries<Periodic, Periodic, Periodic, Periodic>,
+        Stencil>(state, wave_parameters(), decomposition);
 }
 
 int main(int, char **)
 {
+    // Simulated frames; the video has `frame_interval` frames for every
+    // simulated frame.
     const int frames = 1650;
     const size_t width = 300;
     const float dt = 0.005f;
+    // Slows the motion down by this factor; the video frames between
+    // the simulated frames are interpolated in time while they are
+    // shown or recorded, so the solver only runs for the simulated
+    // frames. The spectral solver evaluates them exactly instead, and
+    // the progressive preview holds the simulated frames.
+    const int frame_interval = 1;
+    // Half of the width of the view, for the 16:9 video and window.
+    const float view_extent = 16.0f / 9.0f;
+    const int video_frames = (frames - 1) * frame_interval + 1;
     const bool show_energy = false;
+    const ColorTable colors(
+        show_energy ? colormap_energy() : colormap_amplitude()
+    );
+    // The spectral solver evaluates any frame directly from its time,
+    // so no frames have to be generated before showing them.
+    const bool spectral = true;
+    // Refines the grid of the finite difference solver only around
+    // the wavefronts, in a single process; the frames are resampled
+    // to the full grid.
+    const bool adaptive = false;
+    // Simulates the frames on a grid reduced by this factor first, as
+    // a preview, and then on the full grid in the background, in
+    // a single process; 1 only simulates the full grid.
+    const int preview_reduction = 1;
+    // Number of processes of the finite difference solver, each
+    // simulating a strip of the rows; the root process gathers the
+    // frames and shows them.
+    const int processes = 1;
+    // Pins the workers of the finite difference solver to their own
+    // processors, so their rows stay on the same NUMA node; meant for
+    // a single process, the processes would pin to the same ones.
+    const bool pin_workers = false;
+    // Keeps the frames of the finite difference solvers in
+    // the frame_cache directory; later runs of the same binary show
+    // them without simulating them again.
+    const bool cache_frames = true;
+
+    std::shared_ptr<FrameCache> frame_cache;
+    if (cache_frames && !spectral && preview_reduction == 1)
+    {
+        std::ostringstream parameters;
+        parameters << "frames " << frames << " width " << width << " dt "
+                   << dt << " adaptive " << adaptive;
+        auto created = FrameCache::create(
+            "1_periodic_wave",
+            parameters.str(),
+            frames,
+            glm::uvec2(width),
+            sizeof(Real)
+        );
+        // Without the cache, the frames are simulated and kept in
+        // memory.
+        if (created)
+            frame_cache = created.value();
+    }
+    const bool cached = frame_cache && frame_cache->is_complete();
 
-    Field field(width, width);
+    // The processes are forked before creating any field.
+    std::shared_ptr<Decomposition> decomposition;
+    if (!spectral && !adaptive && preview_reduction == 1 && !cached)
+    {
+        auto created = Decomposition::create(
+            glm::uvec2(width), processes, Stencil::radius, true
+        );
+        if (!created)
+            return EXIT_FAILURE;
+        decomposition = created.value();
+    }
+    Workers::configure(
+        std::max(std::thread::hardware_concurrency() / processes, 1u),
+        pin_workers
+    );
+
+    Field<Real> field(width, width);
 
     for (size_t x = 0; x != width; ++x)
     {
@@ -294,51 +241,225 @@ int main(int, char **)
         }
     }
 
-    FieldState field_state(field, field);
+    FieldState<Real> field_state(field, field);
 
-    std::cout << std::endl << "Generating fields..." << std::endl << std::endl;
-
-    std::vector<ev::SurfaceData> surface_datas(
-        frames, ev::SurfaceData(std::vector<ev::Vertex>(), 0)
-    );
-    const auto start_time = std::chrono::system_clock::now();
-    for (int frame = 0; frame != frames; ++frame)
+    std::optional<SpectralSolver> spectral_solver;
+    // Simulated frames of the finite difference solvers without
+    // the cache; their surface data is only generated when they are
+    // shown.
+    std::vector<FieldState<Real>> states;
+    auto store_state = [&](const int frame, const FieldState<Real> &state)
     {
-        surface_datas[frame] =
-            field_state_to_surface_data(field_state, show_energy);
-        field_state = runge_kutta_iteration<FieldState>(
-            0.0f, field_state, iterate_field, dt
+        if (frame_cache)
+            frame_cache->store(frame, state);
+        else
+            states.push_back(state);
+    };
+    std::optional<ProgressiveFrames> progressive_frames;
+    if (spectral)
+    {
+        spectral_solver.emplace(
+            FieldState<float>(field_state),
+            wave_parameters(),
+            &laplacian_symbol<Stencil>
+        );
+    }
+    else if (preview_reduction > 1)
+    {
+        std::cout << std::endl
+                  << "Generating preview..." << std::endl
+                  << std::endl;
+
+        progressive_frames.emplace(
+            frames,
+            preview_reduction,
+            [&](const int reduction, const ProgressiveFrames::Emit &emit)
+            {
+                WaveParameters parameters = wave_parameters();
+                parameters.dx *= reduction;
+                parameters.dy *= reduction;
+                FieldState<Real> state(
+                    downsample(field_state.amp, reduction),
+                    downsample(field_state.vel, reduction)
+                );
+                GridSurface grid =
+                    periodic_grid(state.amp.get_size(), view_extent);
+                const auto start_time = std::chrono::system_clock::now();
+                for (int frame = 0; frame != frames; ++frame)
+                {
+                    if (!emit(
+                            frame,
+                            field_state_to_surface_data(
+                                grid, state, parameters, show_energy, colors
+                            )
+                        ))
+                    {
+                        return;
+                    }
+                    state = runge_kutta_iteration<FieldState<Real>>(
+                        0.0f,
+                        state,
+                        [&](const float, const FieldState<Real> &stage)
+                        {
+                            return wave_iteration<
+                                Boundaries<
+                                    Periodic,
+                                    Periodic,
+                                    Periodic,
+                                    Periodic>,
+                                Stencil>(stage, parameters);
+                        },
+                        dt
+                    );
+
+                    // The full grid is simulated in the background.
+                    if (reduction != 1)
+                    {
+                        print_progress(
+                            static_cast<float>(frame) / (frames - 1),
+                            start_time
+                        );
+                    }
+                }
+            }
         );
 
-        print_progress(static_cast<float>(frame) / (frames - 1), start_time);
+        std::cout << std::endl;
+    }
+    else if (cached)
+    {
+        std::cout << std::endl
+                  << "Showing cached fields." << std::endl
+                  << std::endl;
     }
+    else if (adaptive)
+    {
+        std::cout << std::endl
+                  << "Generating fields..." << std::endl
+                  << std::endl;
+
+        AmrSolver amr_solver(
+            FieldState<float>(field_state),
+            wave_parameters(),
+            AmrParameters{16, 1e-3f, 2},
+            AmrSolver::stencil<Stencil>()
+        );
+        const auto start_time = std::chrono::system_clock::now();
+        for (int frame = 0; frame != frames; ++frame)
+        {
+            store_state(frame, FieldState<Real>(amr_solver.uniform()));
+            amr_solver.step(dt);
 
-    std::cout << std::endl;
+            print_progress(
+                static_cast<float>(frame) / (frames - 1), start_time
+            );
+        }
 
-    std::vector<std::shared_ptr<ev::SurfaceVisual>> surfaces;
-    for (int i = -1; i != 2; ++i)
+        if (frame_cache)
+            frame_cache->complete();
+        std::cout << std::endl;
+    }
+    else
     {
-        auto surface = ev::SurfaceVisual::create(
-            ev::SurfaceData(std::vector<ev::Vertex>(), 0)
-        );
-        if (!surface)
-            return EXIT_FAILURE;
-        surface.value()->set_ambient_color(glm::vec3(1.0f));
-        surface.value()->set_diffuse_color(glm::vec3(0.0f));
-        surface.value()->set_specular_color(glm::vec3(0.0f));
-        surface.value()->set_shininess(0.0f);
+        if (decomposition->is_root())
+        {
+            std::cout << std::endl
+                      << "Generating fields..." << std::endl
+                      << std::endl;
+        }
 
-        surface.value()->set_view(glm::mat4(1.0f));
-        const glm::mat4 projection = glm::ortho(-1.0f, +1.0f, -1.0f, +1.0f);
-        surface.value()->set_projection(projection);
+        FieldState<Real> local_state(
+            decomposition->scatter(field_state.amp),
+            decomposition->scatter(field_state.vel)
+        );
+        const auto start_time = std::chrono::system_clock::now();
+        for (int frame = 0; frame != frames; ++frame)
+        {
+            auto amp = decomposition->gather(local_state.amp);
+            auto vel = decomposition->gather(local_state.vel);
+            if (decomposition->is_root())
+                store_state(frame, FieldState<Real>(*amp, *vel));
+            local_state = runge_kutta_iteration<FieldState<Real>>(
+                0.0f,
+                local_state,
+                [&](const float, const FieldState<Real> &state)
+                { return iterate_field(state, *decomposition); },
+                dt
+            );
+
+            if (decomposition->is_root())
+            {
+                print_progress(
+                    static_cast<float>(frame) / (frames - 1), start_time
+                );
+            }
+        }
 
-        const glm::mat4 model =
-            glm::translate(glm::mat4(1.0f), glm::vec3(i * 2.0f, 0.0f, 0.0f));
-        surface.value()->set_model(model);
+        // Only the root process shows the frames.
+        if (!decomposition->is_root())
+            return EXIT_SUCCESS;
 
-        surfaces.push_back(surface.value());
+        if (frame_cache)
+            frame_cache->complete();
+        std::cout << std::endl;
     }
 
+    // State of the video frame, evaluated by the spectral solver or
+    // interpolated between the simulated frames; not available for
+    // the progressive preview, which only keeps surface data.
+    auto frame_state = [&](const int video_frame) -> FieldState<float>
+    {
+        // Simulated frame at or before the video frame, and the fraction
+        // of the way to the next one.
+        const int frame = video_frame / frame_interval;
+        const float s =
+            static_cast<float>(video_frame % frame_interval) / frame_interval;
+        if (spectral_solver)
+        {
+            const float t = (frame + s) * dt;
+            return show_energy ? spectral_solver->state(t)
+                               : FieldState<float>(
+                                     spectral_solver->amplitude(t),
+                                     Field<float>(field.get_size())
+                                 );
+        }
+
+        auto state = [&](const int simulated_frame)
+        {
+            return frame_cache ? frame_cache->load<Real>(simulated_frame)
+                               : states[simulated_frame];
+        };
+        return FieldState<float>(
+            s == 0.0f
+                ? state(frame)
+                : hermite_interpolation(state(frame), state(frame + 1), dt, s)
+        );
+    };
+
+    // Surface data of the video frame last shown, only generated once
+    // while the frame stays the same.
+    GridSurface grid = periodic_grid(field.get_size(), view_extent);
+    std::optional<std::pair<int, ev::SurfaceData>> shown_surface_data;
+    auto surface_data = [&](const int video_frame) -> const ev::SurfaceData &
+    {
+        if (progressive_frames)
+            return progressive_frames->get(video_frame / frame_interval);
+        if (!shown_surface_data || shown_surface_data->first != video_frame)
+        {
+            shown_surface_data = std::make_pair(
+                video_frame,
+                field_state_to_surface_data(
+                    grid,
+                    frame_state(video_frame),
+                    wave_parameters(),
+                    show_energy,
+                    colors
+                )
+            );
+        }
+        return shown_surface_data->second;
+    };
+
     std::string file_name(
         show_energy ? "1_periodic_wave_energy.webm"
                     : "1_periodic_wave_amplitude.webm"
@@ -347,13 +468,102 @@ int main(int, char **)
     unsigned int frame_rate = 30;
     glm::uvec2 video_size(1920, 1080);
     glm::uvec2 window_size(1280, 720);
+    // Records also a smaller video for the web and a thumbnail while
+    // recording the video, instead of playing the frames again.
+    const bool record_variants = false;
+
+    // Renders the video on the processors and pipes it to ffmpeg,
+    // without a window or a graphics context, so it also works on
+    // machines without a GPU; the colors are interpolated between
+    // the cells after coloring them, instead of before.
+    const bool software_render = false;
+    // Splits the frames of the software rendering into chunks rendered
+    // in parallel, each by its own process with a single thread; for
+    // many processors, the rendering and the encoding of one chunk
+    // hardly use more than one.
+    const int render_processes = 1;
+    if (software_render && !progressive_frames)
+    {
+        std::cout << std::endl
+                  << "Generating video..." << std::endl
+                  << std::endl;
+        const auto start_time = std::chrono::system_clock::now();
+        auto render =
+            [&](const int begin, const int end, const std::string &output)
+        {
+            auto writer = Y4mWriter::create(
+                std::vector<std::string>{
+                    "ffmpeg",
+                    "-y",
+                    "-loglevel",
+                    "error",
+                    "-i",
+                    "-",
+                    "-c:v",
+                    "libvpx-vp9",
+                    "-b:v",
+                    std::to_string(bit_rate),
+                    output
+                },
+                video_size,
+                frame_rate
+            );
+            if (!writer)
+                return false;
+
+            YuvFrame yuv_frame(video_size);
+            for (int video_frame = begin; video_frame != end; ++video_frame)
+            {
+                const FieldState<float> state = frame_state(video_frame);
+                rasterize(
+                    show_energy ? energy_field(state, wave_parameters())
+                                : state.amp,
+                    colors,
+                    yuv_frame,
+                    view_extent
+                );
+                if (!writer.value()->write(yuv_frame))
+                    return false;
+
+                // The progress of the first chunk stands for all of them.
+                if (begin == 0)
+                {
+                    print_progress(
+                        static_cast<float>(video_frame + 1) / end, start_time
+                    );
+                }
+            }
+            return true;
+        };
+        const bool rendered =
+            render_chunks(file_name, video_frames, render_processes, render);
+        std::cout << std::endl;
+        return rendered ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // A single surface holds the periodic copies of the field.
+    auto surface = ev::SurfaceVisual::create(
+        ev::SurfaceData(std::vector<ev::Vertex>(), 0)
+    );
+    if (!surface)
+        return EXIT_FAILURE;
+    surface.value()->set_ambient_color(glm::vec3(1.0f));
+    surface.value()->set_diffuse_color(glm::vec3(0.0f));
+    surface.value()->set_specular_color(glm::vec3(0.0f));
+    surface.value()->set_shininess(0.0f);
+
+    surface.value()->set_view(glm::mat4(1.0f));
+    const glm::mat4 projection = glm::ortho(-1.0f, +1.0f, -1.0f, +1.0f);
+    surface.value()->set_projection(projection);
+    surface.value()->set_model(glm::mat4(1.0f));
+
     auto framework = Framework::create(
         file_name,
         bit_rate,
         video_size,
         window_size,
         glm::vec4(1.0f),
-        frames,
+        video_frames,
         frame_rate,
         4,
         1,
@@ -363,14 +573,42 @@ int main(int, char **)
     if (!framework)
         return EXIT_FAILURE;
 
-    for (auto surface : surfaces)
-        framework.value()->add_visual(surface);
+    framework.value()->add_visual(surface.value());
+    if (record_variants)
+    {
+        const std::string stem = file_name.substr(0, file_name.rfind('.'));
+        const VideoOutput variants[] = {
+            {stem + "_720p.webm",
+             glm::uvec2(1280, 720),
+             5000000,
+             AV_CODEC_ID_VP9},
+            {stem + "_thumbnail.webm",
+             glm::uvec2(320, 180),
+             500000,
+             AV_CODEC_ID_VP9}
+        };
+        for (const auto &variant : variants)
+        {
+            if (!framework.value()->add_output(variant))
+                return EXIT_FAILURE;
+        }
+    }
+    if (progressive_frames)
+    {
+        framework.value()->set_preview(
+            [&](const int video_frame)
+            {
+                return progressive_frames->is_preview(
+                    video_frame / frame_interval
+                );
+            }
+        );
+    }
 
     int run_result = framework.value()->run(
         [&](const int frame, const int, const float)
         {
-            for (auto surface : surfaces)
-                surface->set_surface_data(surface_datas[frame]);
+            surface.value()->set_surface_data(surface_data(frame));
         }
     );
 
@@ -1,129 +1,23 @@
+#include <checkpoint.hpp>
 #include <cstdlib>
 #include <elementary_visualizer/elementary_visualizer.hpp>
+#include <field.hpp>
+#include <field_export.hpp>
+#include <frame_store.hpp>
 #include <framework.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <grid_surface.hpp>
 #include <iostream>
+#include <pml.hpp>
+#include <raster.hpp>
+#include <source.hpp>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <wave_solver.hpp>
 
 namespace ev = elementary_visualizer;
 
-class Field
-{
-public:
-
-    Field(size_t size_x, size_t size_y)
-        : size(glm::uvec2(size_x, size_y)), field(size_x * size_y)
-    {}
-
-    Field(glm::uvec2 size) : size(size), field(size.x * size.y) {}
-
-    size_t index(const int x, const int y) const
-    {
-        return Field::mod(y, this->size.y) * this->size.x +
-               Field::mod(x, this->size.x);
-    }
-
-    size_t index(const glm::ivec2 &i) const
-    {
-        return index(i.x, i.y);
-    }
-
-    float operator()(const int x, const int y) const
-    {
-        return this->field[this->index(x, y)];
-    }
-
-    float &operator()(const int x, const int y)
-    {
-        return this->field[this->index(x, y)];
-    }
-
-    glm::uvec2 get_size() const
-    {
-        return this->size;
-    }
-
-private:
-
-    static size_t mod(int n, const int m)
-    {
-        n = n % m;
-        if (n < 0)
-            n += m;
-        return static_cast<size_t>(n);
-    }
-
-    glm::uvec2 size;
-    std::vector<float> field;
-};
-
-Field operator*(float c, Field field)
-{
-    const glm::vec2 size = field.get_size();
-    for (size_t x = 0; x != size.x; ++x)
-    {
-        for (size_t y = 0; y < size.y; ++y)
-        {
-            field(x, y) *= c;
-        }
-    }
-    return field;
-}
-
-Field operator+(Field field_0, const Field &field_1)
-{
-    const glm::vec2 size = field_0.get_size();
-    for (size_t x = 0; x != size.x; ++x)
-    {
-        for (size_t y = 0; y < size.y; ++y)
-        {
-            field_0(x, y) += field_1(x, y);
-        }
-    }
-    return field_0;
-}
-
-float interp(
-    float t, float min, float max, float t_min = 0.0f, float t_max = 1.0f
-)
-{
-    t = (t - t_min) / (t_max - t_min);
-    return min + (max - min) * t;
-}
-
-template <typename T>
-T runge_kutta_iteration(
-    const float t, const T &y, std::function<T(float, T)> f, const float h
-)
-{
-    T k_1 = f(t, y);
-    T k_2 = f(t + 0.5f * h, y + (0.5f * h) * k_1);
-    T k_3 = f(t + 0.5f * h, y + (0.5f * h) * k_2);
-    T k_4 = f(t + h, y + h * k_3);
-    return y + (h / 6.0f) * (k_1 + 2.0f * k_2 + 2.0f * k_3 + k_4);
-}
-
-struct FieldState
-{
-    FieldState(const Field &amp, const Field &vel) : amp(amp), vel(vel) {}
-
-    Field amp;
-    Field vel;
-};
-
-FieldState operator*(float c, const FieldState &field_state)
-{
-    return FieldState(c * field_state.amp, c * field_state.vel);
-}
-
-FieldState
-    operator+(const FieldState &field_state_0, const FieldState &field_state_1)
-{
-    return FieldState(
-        field_state_0.amp + field_state_1.amp,
-        field_state_0.vel + field_state_1.vel
-    );
-}
-
 const std::vector<std::pair<float, glm::vec4>> &colormap_amplitude()
 {
     // static std::vector<std::pair<float, glm::vec4>> colormap = {
@@ -141,159 +35,169 @@ const std::vector<std::pair<float, glm::vec4>> &colormap_amplitude()
     return colormap;
 }
 
-glm::vec4
-    to_color(float v, const std::vector<std::pair<float, glm::vec4>> &colormap)
+// Visible domain within the simulated one, which extends beyond the
+// left, bottom and top edges by the absorbing layers of `layer` cells;
+// the right edge reflects.
+struct Domain
 {
-    if (v < colormap[0].first)
-        return colormap[0].second;
-    if (v > colormap.back().first)
-        return colormap.back().second;
-
-    std::optional<std::pair<float, glm::vec4>> color_begin;
-    std::optional<std::pair<float, glm::vec4>> color_end;
-    for (const auto &color_value : colormap)
+    glm::uvec2 visible_size;
+    int layer;
+
+    glm::uvec2 full_size() const
     {
-        if (color_value.first <= v)
-        {
-            color_begin = color_value;
-        }
-        else if (!color_end)
-        {
-            color_end = color_value;
-            break;
-        }
+        return this->visible_size + glm::uvec2(this->layer, 2 * this->layer);
     }
+};
 
-    if (color_begin && color_end)
+// Cells of the symmetric field of `reduced_size` seen in the visible
+// domain.
+Region visible_region(
+    const glm::uvec2 reduced_size,
+    const Symmetry &symmetry,
+    const Domain &domain
+)
+{
+    Region region{glm::ivec2(0, 0), glm::ivec2(0, 0)};
+    for (size_t y = 0; y != domain.visible_size.y; ++y)
     {
-        return glm::vec4(
-            interp(
-                v,
-                color_begin->second.r,
-                color_end->second.r,
-                color_begin->first,
-                color_end->first
-            ),
-            interp(
-                v,
-                color_begin->second.g,
-                color_end->second.g,
-                color_begin->first,
-                color_end->first
-            ),
-            interp(
-                v,
-                color_begin->second.b,
-                color_end->second.b,
-                color_begin->first,
-                color_end->first
-            ),
-            interp(
-                v,
-                color_begin->second.a,
-                color_end->second.a,
-                color_begin->first,
-                color_end->first
-            )
-        );
+        for (size_t x = 0; x != domain.visible_size.x; ++x)
+        {
+            const glm::ivec2 cell = symmetry.cell(
+                reduced_size, x + domain.layer, y + domain.layer
+            );
+            region = region.unite(Region{cell, cell + glm::ivec2(1)});
+        }
     }
-
-    return glm::vec4();
+    return region;
 }
 
-ev::SurfaceData
-    field_state_to_surface_data(const FieldState &field_state, const bool side)
+// Grid of one half of the visible domain, the full domain is
+// reconstructed from the symmetric field of `reduced_size`; the layers
+// are left out.
+GridSurface half_grid(
+    const glm::uvec2 reduced_size,
+    const Symmetry &symmetry,
+    const Domain &domain,
+    const bool side
+)
 {
-    const glm::uvec2 size(field_state.amp.get_size());
+    const glm::uvec2 size = domain.visible_size;
     const size_t y_shift = side ? 0 : (size.y - 1) / 2;
-    std::vector<ev::Vertex> vertices(size.x * (size.y + 1) / 2);
+    std::vector<glm::vec3> positions(size.x * (size.y + 1) / 2);
+    std::vector<size_t> sources(positions.size());
     for (size_t x = 0; x != size.x; ++x)
     {
         for (size_t y = 0; y < (size.y + 1) / 2; ++y)
         {
-            glm::vec4 color =
-                to_color(field_state.amp(x, y + y_shift), colormap_amplitude());
+            const glm::ivec2 cell = symmetry.cell(
+                reduced_size, x + domain.layer, y + y_shift + domain.layer
+            );
+            sources[y * size.x + x] = cell.y * reduced_size.x + cell.x;
 
             float fx =
                 4.0f * (1.0f * static_cast<float>(x) / (size.x - 1) - 0.5f);
             float fy =
                 4.0f *
                 (1.0f * static_cast<float>(y + y_shift) / (size.y - 1) - 0.5f);
-            glm::vec3 position(fx, fy, 0.1f * field_state.amp(x, y + y_shift));
-            vertices[y * size.x + x] = ev::Vertex(position, color);
+            positions[y * size.x + x] = glm::vec3(fx, fy, 0.0f);
         }
     }
 
-    return ev::SurfaceData(vertices, size.x, ev::SurfaceMode::smooth);
+    return GridSurface(
+        std::move(positions),
+        std::move(sources),
+        size.x,
+        ev::SurfaceMode::smooth
+    );
 }
 
-FieldState
-    iterate_field(const float t, const FieldState &state, const bool boundary)
+WaveParameters scene_wave_parameters()
 {
     const float c = 1.0f;
     const float dx = 0.01f;
-    const float rx = c * c / (dx * dx);
     const float dy = dx;
-    const float ry = c * c / (dy * dy);
+    return WaveParameters{c, dx, dy};
+}
 
-    const glm::uvec2 size(state.amp.get_size());
-    Field acc(state.amp.get_size());
+template <typename B>
+std::function<PmlState(float, PmlState)>
+    scene_iteration(const Pml &pml, const std::vector<Source> &sources)
+{
+    return [&](const float t, const PmlState &state)
+    {
+        PmlState rate = pml_iteration<B>(state, scene_wave_parameters(), pml);
+        add_sources(rate.wave.vel, sources, t);
+        return rate;
+    };
+}
 
-    for (size_t x = 0; x != size.x; ++x)
+// The left edge and the bottom and top edges only let outgoing waves,
+// the boundary condition of the right edge can be set. When only
+// the upper half of the domain is simulated, the bottom edge
+// is the symmetry axis. The outgoing edges are either first order
+// approximations, or perfectly matched layers terminated by
+// Dirichlet boundaries.
+template <typename XMax>
+std::function<PmlState(float, PmlState)> scene_iteration(
+    const Symmetry &symmetry,
+    const bool pml_enabled,
+    const Pml &pml,
+    const std::vector<Source> &sources
+)
+{
+    if (pml_enabled)
     {
-        for (size_t y = 0; y != size.y; ++y)
+        if (symmetry.mirror_y)
         {
-            float fx = static_cast<float>(x) / (size.x - 1) - 0.5f;
-            float fy = static_cast<float>(y) / (size.y - 1) - 0.5f;
-
-            fx += 0.4f;
-            const float tt = t * 25.0f;
-            float source = sinf(tt * 2 * std::numbers::pi) * 2700.0f *
-                           expf(-750.0f * (fx * fx + fy * fy));
-            if (tt > 4.0f)
-                source = 0.0f;
-
-            float amp_plus_dx =
-                (x != (size.x - 1))
-                    ? state.amp(x + 1, y)
-                    // Only outgoing wave.
-                    // : state.amp(x + 1, y) - 2 * dx * state.vel(x, y) / c;
-                    : (boundary ?
-                                // Dirichlet.
-                           0.0f
-                                // Neumann.
-                                : state.amp(x, y));
-            float amp_minus_dx =
-                (x != 0) ? state.amp(x - 1, y)
-                         : state.amp(x + 1, y) - 2 * dx * state.vel(x, y) / c;
-
-            float amp_plus_dy =
-                (y != (size.y - 1))
-                    ? state.amp(x, y + 1)
-                    : state.amp(x, y - 1) - 2.0f * dy * state.vel(x, y) / c;
-            float amp_minus_dy = (y != 0) ? state.amp(x, y - 1)
-                                          : state.amp(x, y + 1) -
-                                                2.0f * dy * state.vel(x, y) / c;
-            // float amp_plus_dy = state.amp(x, y + 1);
-            // float amp_minus_dy = state.amp(x, y - 1);
-
-            acc(x, y) = rx * (amp_minus_dx + amp_plus_dx) +
-                        ry * (amp_minus_dy + amp_plus_dy) -
-                        2.0f * (rx + ry) * state.amp(x, y) + source;
+            return scene_iteration<
+                Boundaries<Dirichlet, XMax, Mirror, Dirichlet>>(pml, sources);
         }
+        return scene_iteration<
+            Boundaries<Dirichlet, XMax, Dirichlet, Dirichlet>>(pml, sources);
     }
 
-    return FieldState(state.vel, acc);
+    if (symmetry.mirror_y)
+    {
+        return scene_iteration<Boundaries<Outgoing, XMax, Mirror, Outgoing>>(
+            pml, sources
+        );
+    }
+    return scene_iteration<Boundaries<Outgoing, XMax, Outgoing, Outgoing>>(
+        pml, sources
+    );
 }
 
-FieldState iterate_field_0(const float t, const FieldState &state)
+// The source lies on the horizontal centerline of the visible domain.
+std::vector<Source> create_sources(
+    const glm::uvec2 size, const Symmetry &symmetry, const Domain &domain
+)
 {
-    return iterate_field(t, state, false);
-}
+    const glm::uvec2 visible_size = domain.visible_size;
+    const glm::ivec2 offset =
+        symmetry.offset(size) - glm::ivec2(domain.layer);
+    const SourceStamp stamp = SourceStamp::create(
+        size,
+        [&](const int x, const int y)
+        {
+            const float fx =
+                static_cast<float>(x + offset.x) / (visible_size.x - 1) -
+                0.1f;
+            const float fy =
+                static_cast<float>(y + offset.y) / (visible_size.y - 1) -
+                0.5f;
+            return expf(-750.0f * (fx * fx + fy * fy));
+        }
+    );
 
-FieldState iterate_field_1(const float t, const FieldState &state)
-{
-    return iterate_field(t, state, true);
+    const float frequency = 5.0f;
+    const float periods = 4.0f;
+    return std::vector<Source>({Source{
+        stamp,
+        [=](const float t)
+        { return sinf(frequency * t * 2 * std::numbers::pi) * 2700.0f; },
+        0.0f,
+        periods / frequency
+    }});
 }
 
 std::shared_ptr<ev::SurfaceVisual> create_surface()
@@ -326,18 +230,50 @@ std::shared_ptr<ev::SurfaceVisual> create_surface()
     return surface.value();
 }
 
-int main(int, char **)
+// Fields of the checkpoints, in the order of the states.
+void append_fields(std::vector<Field<float>> &fields, const PmlState &state)
+{
+    fields.push_back(state.wave.amp);
+    fields.push_back(state.wave.vel);
+    fields.push_back(state.psi_x);
+    fields.push_back(state.psi_y);
+}
+
+PmlState restore_state(const std::vector<Field<float>> &fields, const int i)
+{
+    return PmlState(
+        FieldState<float>(fields[4 * i], fields[4 * i + 1]),
+        fields[4 * i + 2],
+        fields[4 * i + 3]
+    );
+}
+
+// With --resume, the simulation continues from the latest checkpoint
+// of an earlier run with the same parameters, and shows the frames
+// from there on.
+int main(int argc, char **argv)
 {
+    const bool resume = argc > 1 && std::string(argv[1]) == "--resume";
     const int frames = 1000;
     const size_t width = 201;
     // const float dt = 0.01f;
     const float dt = 0.005;
+    // The scene is symmetric to the horizontal centerline,
+    // so only the upper half of it is simulated.
+    const bool mirror = true;
+    const Symmetry symmetry{false, mirror};
 
-    Field field(width, width);
+    // Absorbing layers on the outgoing edges, outside of the visible
+    // domain; without them the first order outgoing boundary reflects
+    // at oblique angles.
+    const bool pml_enabled = true;
+    const Domain domain{glm::uvec2(width, width), pml_enabled ? 10 : 0};
 
-    for (size_t x = 0; x != width; ++x)
+    Field<float> field(symmetry.reduced_size(domain.full_size()));
+
+    for (size_t x = 0; x != field.get_size().x; ++x)
     {
-        for (size_t y = 0; y != width; ++y)
+        for (size_t y = 0; y != field.get_size().y; ++y)
         {
             // const float fx = static_cast<float>(x) / (width - 1) - 0.5f;
             // const float fy = static_cast<float>(y) / (width - 1) - 0.5f;
@@ -346,37 +282,159 @@ int main(int, char **)
         }
     }
 
-    FieldState field_state_0(field, field);
-    FieldState field_state_1(field, field);
+    // Only the cells which are reached by the wave are simulated;
+    // values below the tolerance are treated as zero.
+    const float tolerance = 1e-6f;
+    field.shrink_region();
 
-    std::cout << std::endl << "Generating fields..." << std::endl << std::endl;
+    PmlState field_state_0(FieldState<float>(field, field), field, field);
+    PmlState field_state_1(FieldState<float>(field, field), field, field);
+
+    const Pml pml(
+        field.get_size(),
+        scene_wave_parameters(),
+        PmlParameters{domain.layer, 3.0f, 1e-4f, true, false, !mirror, true}
+    );
+
+    const std::vector<Source> sources =
+        create_sources(field.get_size(), symmetry, domain);
+    const auto iterate_field_0 =
+        scene_iteration<Neumann>(symmetry, pml_enabled, pml, sources);
+    const auto iterate_field_1 =
+        scene_iteration<Dirichlet>(symmetry, pml_enabled, pml, sources);
+
+    // The time is that of the steps, so the number of frames is not
+    // part of the parameters: a run resumed with more frames extends
+    // the earlier one.
+    std::ostringstream parameters;
+    parameters << "width " << width << " dt " << dt << " mirror " << mirror
+               << " tolerance " << tolerance << " pml " << domain.layer;
+
+    // Writes the amplitudes of the simulated half of both simulations,
+    // without the layers, to .npy files in every frame, see
+    // FieldExporter; without showing the frames, none of them are
+    // rendered.
+    const bool export_fields = false;
+    const bool show_frames = true;
+    std::shared_ptr<FieldExporter> exporters[2];
+    if (export_fields)
+    {
+        const Region region =
+            visible_region(field.get_size(), symmetry, domain);
+        const char *file_names[2] = {
+            "2_boundary_conditions_neumann.npy",
+            "2_boundary_conditions_dirichlet.npy"
+        };
+        for (const int i : {0, 1})
+        {
+            auto exporter = FieldExporter::create(file_names[i], region);
+            if (!exporter)
+                return EXIT_FAILURE;
+            exporters[i] = exporter.value();
+        }
+    }
 
-    std::vector<ev::SurfaceData> surface_datas_0(
-        frames, ev::SurfaceData(std::vector<ev::Vertex>(), 0)
+    // The amplitudes of the frames are kept compressed, and rendered
+    // when they are shown; the quantization is far below the height
+    // visible in the frames.
+    const float quantization_step = 1e-3f;
+    const int keyframe_interval = 16;
+    CompressedFrames frames_0(
+        field.get_size(), quantization_step, keyframe_interval
     );
-    std::vector<ev::SurfaceData> surface_datas_1(
-        frames, ev::SurfaceData(std::vector<ev::Vertex>(), 0)
+    CompressedFrames frames_1(
+        field.get_size(), quantization_step, keyframe_interval
     );
+
+    // Steps between the checkpoints; they are written in the background,
+    // with the frames simulated so far, so a resumed run shows them too.
+    // The last frame is followed by a checkpoint as well, to extend the
+    // run with more frames later.
+    const int checkpoint_interval = 100;
+    CheckpointWriter checkpoint_writer("2_boundary_conditions");
+    auto write_checkpoint = [&](const int frame, const float t)
+    {
+        Checkpoint checkpoint{frame, t, parameters.str(), {}, {}};
+        append_fields(checkpoint.fields, field_state_0);
+        append_fields(checkpoint.fields, field_state_1);
+        frames_0.save(checkpoint.data);
+        frames_1.save(checkpoint.data);
+        checkpoint_writer.write(std::move(checkpoint));
+    };
+
+    int first_frame = 0;
+    float first_time = 0.0f;
+    if (resume)
+    {
+        const auto checkpoint = load_latest_checkpoint(
+            "2_boundary_conditions", parameters.str()
+        );
+        // The frames are only kept when they are shown, a checkpoint of
+        // a run without them does not resume one with them.
+        size_t offset = 0;
+        if (!checkpoint || checkpoint->step > frames ||
+            !frames_0.restore(checkpoint->data, offset) ||
+            !frames_1.restore(checkpoint->data, offset) ||
+            frames_0.size() != (show_frames ? checkpoint->step : 0))
+        {
+            std::cerr << "No checkpoint to resume from." << std::endl;
+            return EXIT_FAILURE;
+        }
+        first_frame = checkpoint->step;
+        first_time = checkpoint->time;
+        field_state_0 = restore_state(checkpoint->fields, 0);
+        field_state_1 = restore_state(checkpoint->fields, 1);
+        std::cout << std::endl
+                  << "Resuming from frame " << first_frame << "." << std::endl;
+    }
+
+    std::cout << std::endl << "Generating fields..." << std::endl << std::endl;
+
     const auto start_time = std::chrono::system_clock::now();
-    for (int frame = 0; frame != frames; ++frame)
+    for (int frame = first_frame; frame != frames; ++frame)
     {
-        const float t = static_cast<float>(frame) / (frames - 1);
+        const float t = first_time + (frame - first_frame) * dt;
+
+        if (frame % checkpoint_interval == 0 && frame != first_frame)
+            write_checkpoint(frame, t);
 
-        surface_datas_0[frame] =
-            field_state_to_surface_data(field_state_0, false);
-        field_state_0 = runge_kutta_iteration<FieldState>(
+        if (export_fields)
+        {
+            exporters[0]->write(field_state_0.wave.amp);
+            exporters[1]->write(field_state_1.wave.amp);
+        }
+
+        if (show_frames)
+            frames_0.push_back(field_state_0.wave.amp);
+        field_state_0 = runge_kutta_iteration<PmlState>(
             t, field_state_0, iterate_field_0, dt
         );
-        surface_datas_1[frame] =
-            field_state_to_surface_data(field_state_1, true);
-        field_state_1 = runge_kutta_iteration<FieldState>(
+        shrink_region(field_state_0, tolerance);
+        if (show_frames)
+            frames_1.push_back(field_state_1.wave.amp);
+        field_state_1 = runge_kutta_iteration<PmlState>(
             t, field_state_1, iterate_field_1, dt
         );
+        shrink_region(field_state_1, tolerance);
 
-        print_progress(t, start_time);
+        print_progress(
+            static_cast<float>(frame - first_frame + 1) /
+                (frames - first_frame),
+            start_time
+        );
     }
+    if (frames != first_frame)
+        write_checkpoint(frames, first_time + (frames - first_frame) * dt);
 
     std::cout << std::endl;
+    if (frames_0.clamped() != 0 || frames_1.clamped() != 0)
+    {
+        std::cerr << "Amplitudes outside of the range of the frames were "
+                     "clamped."
+                  << std::endl;
+    }
+    if (!show_frames)
+        return EXIT_SUCCESS;
 
     std::string file_name("2_boundary_conditions.webm");
     unsigned int bit_rate = 10000000;
@@ -408,11 +466,28 @@ int main(int, char **)
     framework.value()->add_visual(surface_0);
     framework.value()->add_visual(surface_1);
 
+    GridSurface grid_0 =
+        half_grid(field.get_size(), symmetry, domain, false);
+    GridSurface grid_1 = half_grid(field.get_size(), symmetry, domain, true);
+
+    // The amplitudes raise the vertices by a tenth of them.
+    const ColorTable colors(colormap_amplitude());
+    auto color = [&](const float amp) { return colors.color(amp); };
+    const float height_scale = 0.1f;
+
+    int shown_frame = -1;
     int run_result = framework.value()->run(
         [&](const int frame, const int, const float)
         {
-            surface_0->set_surface_data(surface_datas_0[frame]);
-            surface_1->set_surface_data(surface_datas_1[frame]);
+            if (frame == shown_frame)
+                return;
+            surface_0->set_surface_data(grid_0.surface_data(
+                frames_0.get(frame).data(), color, height_scale
+            ));
+            surface_1->set_surface_data(grid_1.surface_data(
+                frames_1.get(frame).data(), color, height_scale
+            ));
+            shown_frame = frame;
         }
     );
 
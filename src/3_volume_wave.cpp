@@ -0,0 +1,187 @@
+#include <cmath>
+#include <cstdlib>
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <field.hpp>
+#include <field3.hpp>
+#include <framework.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <grid_surface.hpp>
+#include <iostream>
+#include <raster.hpp>
+#include <utility>
+#include <wave_solver3.hpp>
+
+namespace ev = elementary_visualizer;
+
+const std::vector<std::pair<float, glm::vec4>> &colormap_amplitude()
+{
+    static std::vector<std::pair<float, glm::vec4>> colormap = {
+        std::make_pair(-1.00f, glm::vec4(0.35f, 0.10f, 0.10f, 1.00f)),
+        std::make_pair(-0.33f, glm::vec4(1.00f, 0.80f, 0.70f, 1.00f)),
+        std::make_pair(+0.00f, glm::vec4(1.00f, 1.00f, 1.00f, 1.00f)),
+        std::make_pair(+0.33f, glm::vec4(0.55f, 0.75f, 0.85f, 1.00f)),
+        std::make_pair(+1.00f, glm::vec4(0.00f, 0.20f, 0.25f, 1.00f))
+    };
+
+    return colormap;
+}
+
+// Grid of the height maps of the planes extracted from the volume;
+// only the planes of the frames are kept, never the volume itself.
+GridSurface plane_grid(const glm::uvec2 size)
+{
+    std::vector<glm::vec3> positions(size.x * size.y);
+    std::vector<size_t> sources(positions.size());
+    for (size_t y = 0; y != size.y; ++y)
+    {
+        for (size_t x = 0; x != size.x; ++x)
+        {
+            const float fx = 2.0f * static_cast<float>(x) / (size.x - 1) - 1.0f;
+            const float fy = 2.0f * static_cast<float>(y) / (size.y - 1) - 1.0f;
+            positions[y * size.x + x] = glm::vec3(fx, fy, 0.0f);
+            sources[y * size.x + x] = y * size.x + x;
+        }
+    }
+
+    return GridSurface(
+        std::move(positions),
+        std::move(sources),
+        size.x,
+        ev::SurfaceMode::smooth
+    );
+}
+
+WaveParameters3 wave_parameters()
+{
+    const float c = 1.0f;
+    const float dx = 0.01f;
+    return WaveParameters3{c, dx, dx, dx};
+}
+
+using Stencil = FourthOrder;
+
+FieldState3<float> iterate_field(const float, const FieldState3<float> &state)
+{
+    return wave_iteration3<Stencil>(state, wave_parameters());
+}
+
+int main(int, char **)
+{
+    const int frames = 600;
+    const size_t width = 96;
+    const float dt = 0.002f;
+
+    // Pulse off the center of the periodic cube, so the slice through
+    // the center and the projection along z differ.
+    Field3<float> field(width, width, width);
+    for (size_t z = 0; z != width; ++z)
+    {
+        for (size_t y = 0; y != width; ++y)
+        {
+            for (size_t x = 0; x != width; ++x)
+            {
+                const float fx = static_cast<float>(x) / (width - 1) - 0.5f;
+                const float fy = static_cast<float>(y) / (width - 1) - 0.5f;
+                const float fz = static_cast<float>(z) / (width - 1) - 0.35f;
+                field(x, y, z) =
+                    4.0f * expf(-600.0f * (fx * fx + fy * fy + fz * fz));
+            }
+        }
+    }
+
+    FieldState3<float> field_state(field, Field3<float>(field.get_size()));
+
+    std::cout << std::endl << "Generating fields..." << std::endl << std::endl;
+
+    std::vector<ev::SurfaceData> slices(
+        frames, ev::SurfaceData(std::vector<ev::Vertex>(), 0)
+    );
+    std::vector<ev::SurfaceData> projections(
+        frames, ev::SurfaceData(std::vector<ev::Vertex>(), 0)
+    );
+    // The amplitudes raise the vertices by a fifth of them.
+    GridSurface grid = plane_grid(glm::uvec2(width, width));
+    const ColorTable colors(colormap_amplitude());
+    auto color = [&](const float amp) { return colors.color(amp); };
+    const float height_scale = 0.2f;
+    const auto start_time = std::chrono::system_clock::now();
+    for (int frame = 0; frame != frames; ++frame)
+    {
+        const Field<float> slice_plane =
+            slice(field_state.amp, Axis::z, width / 2);
+        slices[frame] =
+            grid.surface_data(slice_plane.data(), color, height_scale);
+        const Field<float> projection_plane =
+            projection(field_state.amp, Axis::z);
+        projections[frame] =
+            grid.surface_data(projection_plane.data(), color, height_scale);
+        field_state = runge_kutta_iteration<FieldState3<float>>(
+            0.0f, field_state, iterate_field, dt
+        );
+
+        print_progress(static_cast<float>(frame) / (frames - 1), start_time);
+    }
+
+    std::cout << std::endl;
+
+    std::vector<std::shared_ptr<ev::SurfaceVisual>> surfaces;
+    for (int i = 0; i != 2; ++i)
+    {
+        auto surface = ev::SurfaceVisual::create(
+            ev::SurfaceData(std::vector<ev::Vertex>(), 0)
+        );
+        if (!surface)
+            return EXIT_FAILURE;
+        surface.value()->set_ambient_color(glm::vec3(1.0f));
+        surface.value()->set_diffuse_color(glm::vec3(0.0f));
+        surface.value()->set_specular_color(glm::vec3(0.0f));
+        surface.value()->set_shininess(0.0f);
+
+        surface.value()->set_view(glm::mat4(1.0f));
+        const glm::mat4 projection = glm::ortho(-2.2f, +2.2f, -1.2f, +1.2f);
+        surface.value()->set_projection(projection);
+
+        const glm::mat4 model = glm::translate(
+            glm::mat4(1.0f), glm::vec3(i * 2.2f - 1.1f, 0.0f, 0.0f)
+        );
+        surface.value()->set_model(model);
+
+        surfaces.push_back(surface.value());
+    }
+
+    std::string file_name("3_volume_wave.webm");
+    unsigned int bit_rate = 10000000;
+    unsigned int frame_rate = 30;
+    glm::uvec2 video_size(1920, 1080);
+    glm::uvec2 window_size(1280, 720);
+    auto framework = Framework::create(
+        file_name,
+        bit_rate,
+        video_size,
+        window_size,
+        glm::vec4(1.0f),
+        frames,
+        frame_rate,
+        4,
+        1,
+        2,
+        1
+    );
+    if (!framework)
+        return EXIT_FAILURE;
+
+    for (auto surface : surfaces)
+        framework.value()->add_visual(surface);
+
+    // The slice through the center on the left, the projection of
+    // the whole volume on the right.
+    int run_result = framework.value()->run(
+        [&](const int frame, const int, const float)
+        {
+            surfaces[0]->set_surface_data(slices[frame]);
+            surfaces[1]->set_surface_data(projections[frame]);
+        }
+    );
+
+    return run_result;
+}
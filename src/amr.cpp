@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <amr.hpp>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+
+int mod(int n, const int m)
+{
+    n = n % m;
+    if (n < 0)
+        n += m;
+    return n;
+}
+
+// Every second cell of the fine grid.
+Field<float> restrict_field(const Field<float> &fine)
+{
+    const glm::uvec2 size = fine.get_size() / 2u;
+    Field<float> coarse(size);
+    for (size_t y = 0; y != size.y; ++y)
+    {
+        for (size_t x = 0; x != size.x; ++x)
+            coarse(x, y) = fine(2 * x, 2 * y);
+    }
+    return coarse;
+}
+
+// Bilinear interpolation of the coarse grid at the fine cell (x, y);
+// the fine cells with even coordinates coincide with coarse cells.
+float interpolate(const Field<float> &coarse, const int x, const int y)
+{
+    const int coarse_x = x >> 1;
+    const int coarse_y = y >> 1;
+    const float wx = (x & 1) ? 0.5f : 0.0f;
+    const float wy = (y & 1) ? 0.5f : 0.0f;
+    return (1.0f - wy) * ((1.0f - wx) * coarse(coarse_x, coarse_y) +
+                          wx * coarse(coarse_x + 1, coarse_y)) +
+           wy * ((1.0f - wx) * coarse(coarse_x, coarse_y + 1) +
+                 wx * coarse(coarse_x + 1, coarse_y + 1));
+}
+
+// Largest change of the amplitude between neighbouring cells, or of
+// its second difference, around the cell.
+float refinement_estimate(const Field<float> &amp, const int x, const int y)
+{
+    const float center = amp(x, y);
+    float estimate = 0.0f;
+    for (const glm::ivec2 axis : {glm::ivec2(1, 0), glm::ivec2(0, 1)})
+    {
+        const float minus = amp(x - axis.x, y - axis.y);
+        const float plus = amp(x + axis.x, y + axis.y);
+        estimate = std::max(
+            {estimate,
+             0.5f * std::abs(plus - minus),
+             std::abs(plus - 2.0f * center + minus)}
+        );
+    }
+    return estimate;
+}
+
+}
+
+AmrSolver::AmrSolver(
+    const FieldState<float> &initial,
+    const WaveParameters &parameters,
+    const AmrParameters &amr_parameters,
+    const Stencil &stencil
+)
+    : coarse_size(glm::ivec2(initial.amp.get_size()) / 2),
+      fine_size(initial.amp.get_size()),
+      blocks(
+          (this->coarse_size + amr_parameters.block_size - 1) /
+          amr_parameters.block_size
+      ),
+      coarse_parameters{
+          parameters.c, 2.0f * parameters.dx, 2.0f * parameters.dy
+      },
+      fine_parameters(parameters),
+      amr_parameters(amr_parameters),
+      stencil_iterations(stencil),
+      // One Runge-Kutta step spreads the stencil four times.
+      ghosts(4 * stencil.radius),
+      coarse(restrict_field(initial.amp), restrict_field(initial.vel)),
+      patches(this->blocks.x * this->blocks.y),
+      steps(0)
+{
+    this->regrid(&initial);
+}
+
+void AmrSolver::step(const float dt)
+{
+    const FieldState<float> previous = this->coarse;
+    this->coarse = runge_kutta_iteration<FieldState<float>>(
+        0.0f,
+        this->coarse,
+        [&](const float, const FieldState<float> &state)
+        {
+            return this->stencil_iterations.coarse(
+                state, this->coarse_parameters
+            );
+        },
+        dt
+    );
+
+    for (const float theta : {0.0f, 0.5f})
+    {
+        this->fill_ghosts(previous, theta);
+        for (auto &patch : this->patches)
+        {
+            if (!patch)
+                continue;
+            patch->state = runge_kutta_iteration<FieldState<float>>(
+                0.0f,
+                patch->state,
+                [&](const float, const FieldState<float> &state)
+                {
+                    return this->stencil_iterations.patch(
+                        state, this->fine_parameters
+                    );
+                },
+                0.5f * dt
+            );
+        }
+    }
+
+    this->restrict_patches();
+    if (++this->steps % this->amr_parameters.regrid_interval == 0)
+        this->regrid(nullptr);
+}
+
+FieldState<float> AmrSolver::uniform() const
+{
+    FieldState<float> fine(
+        Field<float>(this->fine_size), Field<float>(this->fine_size)
+    );
+    for (int y = 0; y != this->fine_size.y; ++y)
+    {
+        for (int x = 0; x != this->fine_size.x; ++x)
+        {
+            const auto &patch = this->patches[this->block_index(x, y)];
+            if (patch)
+            {
+                const glm::ivec2 cell = glm::ivec2(x, y) - patch->origin;
+                fine.amp(x, y) = patch->state.amp(cell.x, cell.y);
+                fine.vel(x, y) = patch->state.vel(cell.x, cell.y);
+            }
+            else
+            {
+                fine.amp(x, y) = interpolate(this->coarse.amp, x, y);
+                fine.vel(x, y) = interpolate(this->coarse.vel, x, y);
+            }
+        }
+    }
+    return fine;
+}
+
+int AmrSolver::refined_blocks() const
+{
+    return std::count_if(
+        this->patches.begin(),
+        this->patches.end(),
+        [](const std::optional<Patch> &patch) { return patch.has_value(); }
+    );
+}
+
+float AmrSolver::relative_cost() const
+{
+    size_t cells = this->coarse_size.x * this->coarse_size.y;
+    for (const auto &patch : this->patches)
+    {
+        if (!patch)
+            continue;
+        const glm::uvec2 size = patch->state.amp.get_size();
+        cells += 2 * size.x * size.y;
+    }
+    return static_cast<float>(cells) /
+           (2.0f * this->fine_size.x * this->fine_size.y);
+}
+
+int AmrSolver::block_index(const int fine_x, const int fine_y) const
+{
+    const int block_size = this->amr_parameters.block_size;
+    const int x = mod(fine_x, this->fine_size.x) / 2 / block_size;
+    const int y = mod(fine_y, this->fine_size.y) / 2 / block_size;
+    return y * this->blocks.x + x;
+}
+
+void AmrSolver::regrid(const FieldState<float> *fine)
+{
+    const int block_size = this->amr_parameters.block_size;
+    // The waves travel less than a coarse cell per step.
+    const int margin = this->amr_parameters.regrid_interval + 1;
+    const glm::ivec2 size = this->coarse_size;
+    std::vector<bool> flagged(size.x * size.y);
+    for (int y = 0; y != size.y; ++y)
+    {
+        for (int x = 0; x != size.x; ++x)
+        {
+            flagged[y * size.x + x] =
+                refinement_estimate(this->coarse.amp, x, y) >
+                this->amr_parameters.threshold;
+        }
+    }
+
+    // Dilates the flagged cells by the margin, along x and then along y.
+    for (const glm::ivec2 axis : {glm::ivec2(1, 0), glm::ivec2(0, 1)})
+    {
+        std::vector<bool> dilated(flagged.size(), false);
+        for (int y = 0; y != size.y; ++y)
+        {
+            for (int x = 0; x != size.x; ++x)
+            {
+                if (!flagged[y * size.x + x])
+                    continue;
+                for (int k = -margin; k <= margin; ++k)
+                {
+                    const int i = mod(x + k * axis.x, size.x);
+                    const int j = mod(y + k * axis.y, size.y);
+                    dilated[j * size.x + i] = true;
+                }
+            }
+        }
+        flagged = std::move(dilated);
+    }
+
+    std::vector<bool> refined(this->patches.size(), false);
+    for (int y = 0; y != size.y; ++y)
+    {
+        for (int x = 0; x != size.x; ++x)
+        {
+            if (flagged[y * size.x + x])
+                refined[this->block_index(2 * x, 2 * y)] = true;
+        }
+    }
+
+    for (int y = 0; y != this->blocks.y; ++y)
+    {
+        for (int x = 0; x != this->blocks.x; ++x)
+        {
+            const bool refine = refined[y * this->blocks.x + x];
+            auto &patch = this->patches[y * this->blocks.x + x];
+            if (!refine)
+            {
+                patch.reset();
+                continue;
+            }
+            if (patch)
+                continue;
+
+            // The block may be smaller at the end of the grid.
+            const glm::ivec2 begin = glm::ivec2(x, y) * block_size;
+            const glm::ivec2 end =
+                glm::min(begin + block_size, this->coarse_size);
+            const glm::ivec2 origin = 2 * begin - this->ghosts;
+            const glm::uvec2 size(2 * (end - begin) + 2 * this->ghosts);
+            const Field<float> zero(size);
+            FieldState<float> state(zero, zero);
+            for (size_t j = 0; j != size.y; ++j)
+            {
+                for (size_t i = 0; i != size.x; ++i)
+                {
+                    const int fine_x = origin.x + i;
+                    const int fine_y = origin.y + j;
+                    if (fine)
+                    {
+                        state.amp(i, j) = fine->amp(fine_x, fine_y);
+                        state.vel(i, j) = fine->vel(fine_x, fine_y);
+                    }
+                    else
+                    {
+                        state.amp(i, j) =
+                            interpolate(this->coarse.amp, fine_x, fine_y);
+                        state.vel(i, j) =
+                            interpolate(this->coarse.vel, fine_x, fine_y);
+                    }
+                }
+            }
+            patch = Patch{origin, state};
+        }
+    }
+}
+
+void AmrSolver::fill_ghosts(
+    const FieldState<float> &previous, const float theta
+)
+{
+    for (auto &patch : this->patches)
+    {
+        if (!patch)
+            continue;
+
+        // Cells of the block, without the ghost cells.
+        const glm::ivec2 size(patch->state.amp.get_size());
+        const glm::ivec2 begin(this->ghosts);
+        const glm::ivec2 end = size - this->ghosts;
+        for (int y = 0; y != size.y; ++y)
+        {
+            for (int x = 0; x != size.x; ++x)
+            {
+                if (begin.x <= x && x < end.x && begin.y <= y && y < end.y)
+                {
+                    // Skips to the ghost cells at the end of the row.
+                    x = end.x - 1;
+                    continue;
+                }
+
+                const int fine_x = patch->origin.x + x;
+                const int fine_y = patch->origin.y + y;
+                const auto &neighbour =
+                    this->patches[this->block_index(fine_x, fine_y)];
+                if (neighbour)
+                {
+                    // Same cell in the neighbour, the blocks wrap around.
+                    const int i = mod(
+                        fine_x - neighbour->origin.x, this->fine_size.x
+                    );
+                    const int j = mod(
+                        fine_y - neighbour->origin.y, this->fine_size.y
+                    );
+                    patch->state.amp(x, y) = neighbour->state.amp(i, j);
+                    patch->state.vel(x, y) = neighbour->state.vel(i, j);
+                    continue;
+                }
+
+                patch->state.amp(x, y) =
+                    (1.0f - theta) *
+                        interpolate(previous.amp, fine_x, fine_y) +
+                    theta * interpolate(this->coarse.amp, fine_x, fine_y);
+                patch->state.vel(x, y) =
+                    (1.0f - theta) *
+                        interpolate(previous.vel, fine_x, fine_y) +
+                    theta * interpolate(this->coarse.vel, fine_x, fine_y);
+            }
+        }
+    }
+}
+
+void AmrSolver::restrict_patches()
+{
+    const int block_size = this->amr_parameters.block_size;
+    for (int y = 0; y != this->blocks.y; ++y)
+    {
+        for (int x = 0; x != this->blocks.x; ++x)
+        {
+            const auto &patch = this->patches[y * this->blocks.x + x];
+            if (!patch)
+                continue;
+
+            const glm::ivec2 begin = glm::ivec2(x, y) * block_size;
+            const glm::ivec2 end =
+                glm::min(begin + block_size, this->coarse_size);
+            for (int j = begin.y; j != end.y; ++j)
+            {
+                for (int i = begin.x; i != end.x; ++i)
+                {
+                    const glm::ivec2 cell =
+                        2 * glm::ivec2(i, j) - patch->origin;
+                    this->coarse.amp(i, j) = patch->state.amp(cell.x, cell.y);
+                    this->coarse.vel(i, j) = patch->state.vel(cell.x, cell.y);
+                }
+            }
+        }
+    }
+}
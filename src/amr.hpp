@@ -0,0 +1,127 @@
+#ifndef SIMULATION_VISUALIZATIONS_AMR_HPP
+#define SIMULATION_VISUALIZATIONS_AMR_HPP
+
+#include <field.hpp>
+#include <optional>
+#include <vector>
+#include <wave_solver.hpp>
+
+struct AmrParameters
+{
+    // Number of coarse cells along each side of the blocks refined
+    // together.
+    int block_size;
+    // Blocks are refined where the amplitude changes by more than
+    // the threshold between neighbouring coarse cells, or where its
+    // second difference exceeds it.
+    float threshold;
+    // Number of coarse steps between recomputing the refined blocks;
+    // the blocks are refined as far around the flagged cells as
+    // the waves travel in between.
+    int regrid_interval;
+};
+
+// Block structured adaptive mesh refinement of the wave equation on
+// fully periodic grids. The whole domain is simulated on a grid twice
+// as coarse as the fine grid, and the blocks of it around the
+// wavefronts are additionally simulated on patches of the fine grid.
+//
+// Every coarse step is followed by two fine steps of half the length
+// on the patches, so both grids run at the same Courant number. The
+// ghost cells around the patches are copied from the neighbouring
+// patches, or interpolated from the coarse grid in space and time;
+// they are as wide as the stencil reaches in one Runge-Kutta step.
+// The patches then replace the coarse cells of their blocks.
+class AmrSolver
+{
+public:
+
+    using Iteration = FieldState<float> (*)(
+        const FieldState<float> &, const WaveParameters &
+    );
+
+    // Iterations of the coarse grid and of the patches with the same
+    // stencil; the patches are closed by their ghost cells.
+    struct Stencil
+    {
+        int radius;
+        Iteration coarse;
+        Iteration patch;
+    };
+
+    template <typename S>
+    static Stencil stencil()
+    {
+        return Stencil{
+            S::radius,
+            &wave_iteration<
+                Boundaries<Periodic, Periodic, Periodic, Periodic>,
+                S,
+                float>,
+            &wave_iteration<
+                Boundaries<Dirichlet, Dirichlet, Dirichlet, Dirichlet>,
+                S,
+                float>
+        };
+    }
+
+    // The initial state and the parameters are given on the fine grid,
+    // which must have an even size.
+    AmrSolver(
+        const FieldState<float> &initial,
+        const WaveParameters &parameters,
+        const AmrParameters &amr_parameters,
+        const Stencil &stencil = AmrSolver::stencil<SecondOrder>()
+    );
+
+    // Advances the state by `dt`, the time step of the coarse grid.
+    void step(const float dt);
+
+    // State resampled to the fine grid; the cells outside of
+    // the patches are interpolated from the coarse grid.
+    FieldState<float> uniform() const;
+
+    int refined_blocks() const;
+
+    // Cells updated by the last step relative to the cells updated by
+    // the same step on the fine grid.
+    float relative_cost() const;
+
+private:
+
+    struct Patch
+    {
+        // Position of the first cell of the patch on the fine grid,
+        // including the ghost cells.
+        glm::ivec2 origin;
+        FieldState<float> state;
+    };
+
+    int block_index(const int fine_x, const int fine_y) const;
+
+    // Recomputes the refined blocks from the coarse grid, the new
+    // patches are taken from `fine` if given.
+    void regrid(const FieldState<float> *fine);
+
+    // Fills the ghost cells of the patches at the time `theta` of
+    // the coarse step, between the `previous` and the current state.
+    void fill_ghosts(const FieldState<float> &previous, const float theta);
+
+    // Replaces the coarse cells of the refined blocks.
+    void restrict_patches();
+
+    glm::ivec2 coarse_size;
+    glm::ivec2 fine_size;
+    glm::ivec2 blocks;
+    WaveParameters coarse_parameters;
+    WaveParameters fine_parameters;
+    AmrParameters amr_parameters;
+    Stencil stencil_iterations;
+    int ghosts;
+    FieldState<float> coarse;
+    // Patch of every block, if refined.
+    std::vector<std::optional<Patch>> patches;
+    int steps;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <buffer.hpp>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+
+constexpr size_t cache_line = 64;
+constexpr size_t huge_page = 2 << 20;
+
+// Freed huge allocation kept for reuse.
+struct CachedAllocation
+{
+    size_t size;
+    size_t rows;
+    void *start;
+};
+
+// Freed huge allocations kept for reuse; faulting in fresh pages costs
+// more than a pass over the grid, and the kept pages are already
+// placed on the NUMA nodes of the rows of the workers, as long as
+// the same rows reuse them. The oldest are released first.
+struct Cache
+{
+    std::mutex mutex;
+    std::vector<CachedAllocation> allocations;
+    size_t bytes = 0;
+    // Number of huge allocations, selects the offset of the next one.
+    size_t count = 0;
+};
+
+// The cache holds up to this many allocations of the size freed last,
+// about the temporaries of a Runge-Kutta step of a field state; the
+// allocations of other grids are released as the size grows.
+const size_t cached_allocations = 16;
+
+Cache &cache()
+{
+    static Cache cache;
+    return cache;
+}
+
+// Huge allocations start at a varying offset from the huge page;
+// grids aligned the same way map their cells to the same cache sets,
+// and the loads of one grid stall on the stores of another.
+constexpr size_t offsets = 16;
+constexpr size_t offset_step = 4 * cache_line;
+
+// Whether the allocation takes the huge page path; decided by the
+// requested size, the rounded size of smaller requests can reach
+// a huge page without the room for the offset.
+constexpr bool is_huge(const size_t bytes)
+{
+    return bytes >= huge_page;
+}
+
+constexpr size_t allocation_size(const size_t bytes)
+{
+    const size_t alignment = is_huge(bytes) ? huge_page : cache_line;
+    const size_t padded = is_huge(bytes) ? bytes + offsets * offset_step
+                                         : bytes;
+    // The size has to be a multiple of the alignment.
+    return std::max(
+        (padded + alignment - 1) / alignment * alignment, alignment
+    );
+}
+
+// Around the huge page, the small requests are rounded up to it, and
+// the huge ones leave room for the largest offset.
+static_assert(
+    !is_huge(huge_page - cache_line + 1) &&
+    allocation_size(huge_page - cache_line + 1) == huge_page
+);
+static_assert(
+    is_huge(huge_page) &&
+    allocation_size(huge_page) >= huge_page + offsets * offset_step
+);
+
+// The huge page aligned start of the allocation is stored just before
+// the returned pointer.
+void *place(void *start, const size_t index)
+{
+    char *pointer =
+        static_cast<char *>(start) + (1 + index % offsets) * offset_step;
+    reinterpret_cast<void **>(pointer)[-1] = start;
+    return pointer;
+}
+
+void *start(void *pointer)
+{
+    return reinterpret_cast<void **>(pointer)[-1];
+}
+
+}
+
+void *allocate_aligned(const size_t bytes, const size_t rows)
+{
+    const size_t size = allocation_size(bytes);
+    if (!is_huge(bytes))
+    {
+        void *pointer = std::aligned_alloc(cache_line, size);
+        if (!pointer)
+            throw std::bad_alloc();
+        return pointer;
+    }
+
+    size_t index;
+    {
+        std::lock_guard lock(cache().mutex);
+        index = cache().count++;
+        auto &allocations = cache().allocations;
+        for (auto i = allocations.begin(); i != allocations.end(); ++i)
+        {
+            if (i->size == size && i->rows == rows)
+            {
+                void *pointer = i->start;
+                cache().bytes -= size;
+                allocations.erase(i);
+                return place(pointer, index);
+            }
+        }
+    }
+
+    void *pointer = std::aligned_alloc(huge_page, size);
+    if (!pointer)
+        throw std::bad_alloc();
+#ifdef __linux__
+    // Transparent huge pages; only a hint, ignored where unsupported.
+    madvise(pointer, size, MADV_HUGEPAGE);
+#endif
+    return place(pointer, index);
+}
+
+void free_aligned(void *pointer, const size_t bytes, const size_t rows)
+{
+    if (!pointer)
+        return;
+
+    const size_t size = allocation_size(bytes);
+    if (!is_huge(bytes))
+    {
+        std::free(pointer);
+        return;
+    }
+
+    // Released outside of the lock.
+    std::vector<void *> released;
+    {
+        std::lock_guard lock(cache().mutex);
+        auto &allocations = cache().allocations;
+        const size_t capacity = cached_allocations * size;
+        auto kept = allocations.begin();
+        while (kept != allocations.end() && cache().bytes + size > capacity)
+        {
+            released.push_back(kept->start);
+            cache().bytes -= kept->size;
+            ++kept;
+        }
+        allocations.erase(allocations.begin(), kept);
+        allocations.push_back(CachedAllocation{size, rows, start(pointer)});
+        cache().bytes += size;
+    }
+    for (void *start : released)
+        std::free(start);
+}
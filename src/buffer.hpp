@@ -0,0 +1,128 @@
+#ifndef SIMULATION_VISUALIZATIONS_BUFFER_HPP
+#define SIMULATION_VISUALIZATIONS_BUFFER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <workers.hpp>
+
+// Allocates memory aligned to cache lines; allocations of at least
+// a huge page are aligned to huge pages and backed by them where
+// the system supports it. The memory of new allocations is not
+// touched, the freed huge allocations are reused by allocations of
+// the same size and number of `rows`, whose pages are placed on the
+// same NUMA nodes.
+void *allocate_aligned(const size_t bytes, const size_t rows);
+
+void free_aligned(void *pointer, const size_t bytes, const size_t rows);
+
+// Storage of the rows of a grid. The rows are initialized and copied
+// by the workers with their row partitioning, so the memory of each
+// range of rows is placed on the NUMA node of the worker processing
+// it in the solvers.
+template <typename T>
+class Buffer
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+
+    Buffer(const size_t rows, const size_t row_size, const T value)
+        : values(
+              static_cast<T *>(
+                  allocate_aligned(rows * row_size * sizeof(T), rows)
+              )
+          ),
+          rows(rows),
+          row_size(row_size)
+    {
+        Workers::get().run(
+            rows,
+            row_size,
+            [&](const size_t begin, const size_t end)
+            {
+                std::fill(
+                    this->values + begin * row_size,
+                    this->values + end * row_size,
+                    value
+                );
+            }
+        );
+    }
+
+    Buffer(const Buffer &other)
+        : values(static_cast<T *>(
+              allocate_aligned(
+                  other.rows * other.row_size * sizeof(T), other.rows
+              )
+          )),
+          rows(other.rows),
+          row_size(other.row_size)
+    {
+        Workers::get().run(
+            this->rows,
+            this->row_size,
+            [&](const size_t begin, const size_t end)
+            {
+                std::copy(
+                    other.values + begin * this->row_size,
+                    other.values + end * this->row_size,
+                    this->values + begin * this->row_size
+                );
+            }
+        );
+    }
+
+    Buffer(Buffer &&other) noexcept
+        : values(std::exchange(other.values, nullptr)),
+          rows(std::exchange(other.rows, 0)),
+          row_size(std::exchange(other.row_size, 0))
+    {}
+
+    Buffer &operator=(Buffer other) noexcept
+    {
+        std::swap(this->values, other.values);
+        std::swap(this->rows, other.rows);
+        std::swap(this->row_size, other.row_size);
+        return *this;
+    }
+
+    ~Buffer()
+    {
+        free_aligned(this->values, this->size() * sizeof(T), this->rows);
+    }
+
+    size_t size() const
+    {
+        return this->rows * this->row_size;
+    }
+
+    const T &operator[](const size_t i) const
+    {
+        return this->values[i];
+    }
+
+    T &operator[](const size_t i)
+    {
+        return this->values[i];
+    }
+
+    const T *data() const
+    {
+        return this->values;
+    }
+
+    T *data()
+    {
+        return this->values;
+    }
+
+private:
+
+    T *values;
+    size_t rows;
+    size_t row_size;
+};
+
+#endif
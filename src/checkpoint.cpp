@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <checkpoint.hpp>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#include <utility>
+
+namespace
+{
+
+const std::uint64_t magic = 0x5349'4d43'4850'4b54;
+const std::uint32_t version = 2;
+// Number of the latest checkpoint files kept.
+const size_t kept_files = 2;
+
+const std::filesystem::path directory("checkpoints");
+
+std::uint32_t crc_32(const std::byte *data, const size_t size)
+{
+    static const std::array<std::uint32_t, 256> table = []()
+    {
+        std::array<std::uint32_t, 256> table;
+        for (std::uint32_t i = 0; i != 256; ++i)
+        {
+            std::uint32_t c = i;
+            for (int k = 0; k != 8; ++k)
+                c = (c & 1) ? 0xedb8'8320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }();
+
+    std::uint32_t crc = 0xffff'ffff;
+    for (size_t i = 0; i != size; ++i)
+    {
+        crc = table[(crc ^ static_cast<std::uint8_t>(data[i])) & 0xff] ^
+              (crc >> 8);
+    }
+    return crc ^ 0xffff'ffff;
+}
+
+void append(std::vector<std::byte> &bytes, const void *data, const size_t size)
+{
+    const std::byte *begin = static_cast<const std::byte *>(data);
+    bytes.insert(bytes.end(), begin, begin + size);
+}
+
+template <typename T>
+void append(std::vector<std::byte> &bytes, const T &value)
+{
+    append(bytes, &value, sizeof(T));
+}
+
+// Reads the values of the file in order, failing past its end.
+class Reader
+{
+public:
+
+    Reader(const std::vector<std::byte> &bytes) : bytes(bytes), offset(0) {}
+
+    bool read(void *data, const size_t size)
+    {
+        if (size > this->bytes.size() - this->offset)
+            return false;
+        std::memcpy(data, this->bytes.data() + this->offset, size);
+        this->offset += size;
+        return true;
+    }
+
+    template <typename T>
+    bool read(T &value)
+    {
+        return this->read(&value, sizeof(T));
+    }
+
+private:
+
+    const std::vector<std::byte> &bytes;
+    size_t offset;
+};
+
+std::vector<std::byte> serialize(const Checkpoint &checkpoint)
+{
+    std::vector<std::byte> bytes;
+    append(bytes, magic);
+    append(bytes, version);
+    append(bytes, checkpoint.step);
+    append(bytes, checkpoint.time);
+    append(bytes, static_cast<std::uint32_t>(checkpoint.parameters.size()));
+    append(bytes, checkpoint.parameters.data(), checkpoint.parameters.size());
+    append(bytes, static_cast<std::uint32_t>(checkpoint.fields.size()));
+    for (const auto &field : checkpoint.fields)
+    {
+        const glm::uvec2 size = field.get_size();
+        const Region region = field.get_region();
+        append(bytes, size);
+        append(bytes, region.min);
+        append(bytes, region.max);
+        append(bytes, field.data(), size.x * size.y * sizeof(float));
+    }
+    append(bytes, static_cast<std::uint64_t>(checkpoint.data.size()));
+    append(bytes, checkpoint.data.data(), checkpoint.data.size());
+    append(bytes, crc_32(bytes.data(), bytes.size()));
+    return bytes;
+}
+
+std::optional<Checkpoint> deserialize(const std::vector<std::byte> &bytes)
+{
+    std::uint32_t crc;
+    if (bytes.size() < sizeof(crc))
+        return std::nullopt;
+    const size_t content_size = bytes.size() - sizeof(crc);
+    std::memcpy(&crc, bytes.data() + content_size, sizeof(crc));
+    if (crc != crc_32(bytes.data(), content_size))
+        return std::nullopt;
+
+    Reader reader(bytes);
+    std::uint64_t file_magic;
+    std::uint32_t file_version;
+    if (!reader.read(file_magic) || file_magic != magic ||
+        !reader.read(file_version) || file_version != version)
+    {
+        return std::nullopt;
+    }
+
+    Checkpoint checkpoint;
+    std::uint32_t parameters_size;
+    if (!reader.read(checkpoint.step) || !reader.read(checkpoint.time) ||
+        !reader.read(parameters_size))
+    {
+        return std::nullopt;
+    }
+    checkpoint.parameters.resize(parameters_size);
+    std::uint32_t fields;
+    if (!reader.read(checkpoint.parameters.data(), parameters_size) ||
+        !reader.read(fields))
+    {
+        return std::nullopt;
+    }
+    for (std::uint32_t i = 0; i != fields; ++i)
+    {
+        glm::uvec2 size;
+        Region region;
+        if (!reader.read(size) || !reader.read(region.min) ||
+            !reader.read(region.max))
+        {
+            return std::nullopt;
+        }
+        Field<float> field(size);
+        if (!reader.read(field.data(), size.x * size.y * sizeof(float)))
+            return std::nullopt;
+        field.set_region(region);
+        checkpoint.fields.push_back(std::move(field));
+    }
+    std::uint64_t data_size;
+    if (!reader.read(data_size) || data_size > bytes.size())
+        return std::nullopt;
+    checkpoint.data.resize(data_size);
+    if (!reader.read(checkpoint.data.data(), data_size))
+        return std::nullopt;
+    return checkpoint;
+}
+
+// Checkpoint files of `name`, by their step.
+std::vector<std::pair<std::int64_t, std::filesystem::path>>
+    checkpoint_files(const std::string &name)
+{
+    std::vector<std::pair<std::int64_t, std::filesystem::path>> files;
+    std::error_code error;
+    for (const auto &entry :
+         std::filesystem::directory_iterator(directory, error))
+    {
+        const std::string file_name = entry.path().filename().string();
+        const std::string prefix = name + "-";
+        const std::string suffix = ".checkpoint";
+        if (!file_name.starts_with(prefix) || !file_name.ends_with(suffix))
+            continue;
+        const std::string step = file_name.substr(
+            prefix.size(), file_name.size() - prefix.size() - suffix.size()
+        );
+        const bool digits = std::all_of(
+            step.begin(),
+            step.end(),
+            [](const char c) { return std::isdigit(c) != 0; }
+        );
+        if (step.empty() || !digits)
+            continue;
+        files.emplace_back(std::stoll(step), entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+}
+
+CheckpointWriter::CheckpointWriter(const std::string &name)
+    : name(name),
+      stop(false)
+{
+    this->thread = std::thread(
+        [this]()
+        {
+            std::unique_lock lock(this->mutex);
+            while (true)
+            {
+                this->condition.wait(
+                    lock, [this]() { return this->pending || this->stop; }
+                );
+                if (!this->pending)
+                    return;
+                const Checkpoint checkpoint = std::move(*this->pending);
+                this->pending.reset();
+                lock.unlock();
+                this->write_file(checkpoint);
+                lock.lock();
+            }
+        }
+    );
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    {
+        std::lock_guard lock(this->mutex);
+        this->stop = true;
+    }
+    this->condition.notify_one();
+    this->thread.join();
+}
+
+void CheckpointWriter::write(Checkpoint checkpoint)
+{
+    {
+        std::lock_guard lock(this->mutex);
+        this->pending = std::move(checkpoint);
+    }
+    this->condition.notify_one();
+}
+
+void CheckpointWriter::write_file(const Checkpoint &checkpoint)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+        return;
+
+    const std::vector<std::byte> bytes = serialize(checkpoint);
+    const std::filesystem::path path =
+        directory /
+        (this->name + "-" + std::to_string(checkpoint.step) + ".checkpoint");
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+    // The checkpoint only replaces the older ones once it is on disk.
+    const int file =
+        open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+        return;
+    size_t written = 0;
+    while (written != bytes.size())
+    {
+        const ssize_t result =
+            ::write(file, bytes.data() + written, bytes.size() - written);
+        if (result <= 0)
+            break;
+        written += result;
+    }
+    const bool complete = written == bytes.size() && fsync(file) == 0;
+    close(file);
+    if (!complete)
+    {
+        std::filesystem::remove(temporary, error);
+        return;
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+        return;
+
+    auto files = checkpoint_files(this->name);
+    if (files.size() > kept_files)
+    {
+        for (auto i = files.begin(); i != files.end() - kept_files; ++i)
+            std::filesystem::remove(i->second, error);
+    }
+}
+
+std::optional<Checkpoint> load_latest_checkpoint(
+    const std::string &name, const std::string &parameters
+)
+{
+    const auto files = checkpoint_files(name);
+    for (auto i = files.rbegin(); i != files.rend(); ++i)
+    {
+        std::ifstream file(i->second, std::ios::binary | std::ios::ate);
+        if (!file)
+            continue;
+        std::vector<std::byte> bytes(file.tellg());
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+        if (!file)
+            continue;
+        auto checkpoint = deserialize(bytes);
+        if (checkpoint && checkpoint->parameters == parameters)
+            return checkpoint;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,73 @@
+#ifndef SIMULATION_VISUALIZATIONS_CHECKPOINT_HPP
+#define SIMULATION_VISUALIZATIONS_CHECKPOINT_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <field.hpp>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// State of a simulation after `step` steps, to continue it later.
+// The parameters describe the simulation, a checkpoint is only resumed
+// by a simulation with the same description; the fields are the whole
+// state of the solvers, with their regions. The data is any further
+// state of the scene, such as the frames shown so far, stored as it is.
+struct Checkpoint
+{
+    std::int64_t step;
+    float time;
+    std::string parameters;
+    std::vector<Field<float>> fields;
+    std::vector<std::byte> data;
+};
+
+// Writes the checkpoints of a simulation in a background thread, so
+// the solver only waits for copying its fields. Every checkpoint goes
+// to its own file, checkpoints/<name>-<step>.checkpoint, written to
+// a temporary file first and renamed when complete; the two latest
+// files are kept.
+//
+// The files start with a magic number and the format version, and end
+// with a CRC-32 of the rest of the file; the values are stored in
+// the byte order of the machine.
+class CheckpointWriter
+{
+public:
+
+    explicit CheckpointWriter(const std::string &name);
+
+    // Writes the pending checkpoint before returning.
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+    // Queues the checkpoint; replaces the queued one if the previous
+    // checkpoint is still being written, the solver never waits for
+    // the disk.
+    void write(Checkpoint checkpoint);
+
+private:
+
+    void write_file(const Checkpoint &checkpoint);
+
+    std::string name;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::optional<Checkpoint> pending;
+    bool stop;
+    std::thread thread;
+};
+
+// The checkpoint of `name` with the most steps, and with
+// the parameters; damaged files, such as those of a run killed while
+// writing, are skipped.
+std::optional<Checkpoint> load_latest_checkpoint(
+    const std::string &name, const std::string &parameters
+);
+
+#endif
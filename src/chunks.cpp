@@ -0,0 +1,119 @@
+#include <chunks.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <process.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+// Path quoted for the concat list of ffmpeg, where quotes are written
+// as '\''.
+std::string quote(const std::string &path)
+{
+    std::string quoted = "'";
+    for (const char c : path)
+    {
+        if (c == '\'')
+            quoted += "'\\''";
+        else
+            quoted += c;
+    }
+    return quoted + "'";
+}
+
+}
+
+bool render_chunks(
+    const std::string &file_name,
+    const int frames,
+    const int processes,
+    const std::function<bool(const int, const int, const std::string &)>
+        &render
+)
+{
+    if (processes <= 1)
+        return render(0, frames, file_name);
+
+    // Segments next to the video, with its extension.
+    const std::filesystem::path path(file_name);
+    std::vector<std::string> segments;
+    for (int i = 0; i != processes; ++i)
+    {
+        std::filesystem::path segment = path;
+        segment.replace_extension(
+            ".chunk" + std::to_string(i) + path.extension().string()
+        );
+        segments.push_back(segment.string());
+    }
+
+    // The buffered output would be written again by every process.
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    std::vector<pid_t> children;
+    for (int i = 0; i != processes; ++i)
+    {
+        const int begin = frames * i / processes;
+        const int end = frames * (i + 1) / processes;
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            // Leaves without the destructors of the calling process,
+            // the workers do not exist in this one.
+            const bool rendered = render(begin, end, segments[i]);
+            std::fflush(nullptr);
+            std::_Exit(rendered ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        if (pid > 0)
+            children.push_back(pid);
+    }
+
+    bool rendered = children.size() == segments.size();
+    for (const pid_t child : children)
+    {
+        int status;
+        rendered = waitpid(child, &status, 0) == child && WIFEXITED(status) &&
+                   WEXITSTATUS(status) == EXIT_SUCCESS && rendered;
+    }
+
+    const std::string list = file_name + ".chunks";
+    if (rendered)
+    {
+        std::ofstream list_file(list);
+        for (const auto &segment : segments)
+        {
+            list_file << "file "
+                      << quote(std::filesystem::absolute(segment).string())
+                      << std::endl;
+        }
+        list_file.close();
+        const std::vector<std::string> concat = {
+            "ffmpeg",
+            "-y",
+            "-loglevel",
+            "error",
+            "-f",
+            "concat",
+            "-safe",
+            "0",
+            "-i",
+            list,
+            "-c",
+            "copy",
+            file_name
+        };
+        rendered = list_file && run_program(concat);
+    }
+
+    std::error_code error;
+    std::filesystem::remove(list, error);
+    for (const auto &segment : segments)
+        std::filesystem::remove(segment, error);
+    return rendered;
+}
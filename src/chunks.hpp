@@ -0,0 +1,26 @@
+#ifndef SIMULATION_VISUALIZATIONS_CHUNKS_HPP
+#define SIMULATION_VISUALIZATIONS_CHUNKS_HPP
+
+#include <functional>
+#include <string>
+
+// Renders the frames of a video to segments in parallel, each by its
+// own process forked from the calling one, and concatenates them into
+// the video with ffmpeg, without encoding them again; the encoding of
+// every segment starts with a key frame.
+//
+// The forked processes see the frames of the calling process as they
+// were when forking, whether in memory or mapped from a FrameCache,
+// and process the tasks of the workers on their only thread, see
+// Workers. `render` renders the frames [begin, end) to a file and
+// returns whether it succeeded; with one process, it renders all of
+// the frames to the video itself.
+bool render_chunks(
+    const std::string &file_name,
+    const int frames,
+    const int processes,
+    const std::function<bool(const int, const int, const std::string &)>
+        &render
+);
+
+#endif
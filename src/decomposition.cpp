@@ -0,0 +1,224 @@
+#include <csignal>
+#include <cstdlib>
+#include <decomposition.hpp>
+#include <iostream>
+#include <new>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+ev::Expected<std::shared_ptr<Decomposition>, ev::Error> Decomposition::create(
+    const glm::uvec2 size,
+    const int processes,
+    const int halo,
+    const bool periodic_rows
+)
+{
+    // Every strip has to be at least as high as the halo.
+    if (processes < 1 || static_cast<int>(size.y) < processes * halo)
+        return ev::Unexpected<ev::Error>(ev::Error());
+
+    const size_t memory_size =
+        Decomposition::memory_size(size, processes, halo);
+    void *memory = mmap(
+        nullptr,
+        memory_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (memory == MAP_FAILED)
+        return ev::Unexpected<ev::Error>(ev::Error());
+    new (memory) Shared{0, false};
+
+    const pid_t root = getpid();
+    std::vector<pid_t> children;
+    int rank = 0;
+    for (int i = 1; i != processes; ++i)
+    {
+        const pid_t pid = fork();
+        if (pid < 0)
+        {
+            for (const pid_t child : children)
+                kill(child, SIGTERM);
+            for (const pid_t child : children)
+                waitpid(child, nullptr, 0);
+            munmap(memory, memory_size);
+            return ev::Unexpected<ev::Error>(ev::Error());
+        }
+        if (pid == 0)
+        {
+            // Ends with the root, also when it died before this.
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if (getppid() != root)
+                std::_Exit(EXIT_FAILURE);
+            rank = i;
+            children.clear();
+            break;
+        }
+        children.push_back(pid);
+    }
+
+    return std::shared_ptr<Decomposition>(new Decomposition(
+        size,
+        processes,
+        halo,
+        periodic_rows,
+        memory,
+        memory_size,
+        rank,
+        std::move(children)
+    ));
+}
+
+Decomposition::Decomposition(
+    glm::uvec2 size,
+    int processes,
+    int halo,
+    bool periodic_rows,
+    void *memory,
+    size_t memory_size,
+    int rank,
+    std::vector<pid_t> children
+)
+    : size(size),
+      processes(processes),
+      halo(halo),
+      periodic_rows(periodic_rows),
+      shared(static_cast<Shared *>(memory)),
+      shared_size(memory_size),
+      rank(rank),
+      children(std::move(children)),
+      synchronizations(0),
+      exchanges(0)
+{}
+
+Decomposition::~Decomposition()
+{
+    if (this->is_root())
+        this->shared->abandoned.store(true, std::memory_order_release);
+    for (const pid_t child : this->children)
+        waitpid(child, nullptr, 0);
+    munmap(this->shared, this->shared_size);
+}
+
+int Decomposition::halo_below() const
+{
+    if (this->processes == 1)
+        return 0;
+    return (this->rank != 0 || this->periodic_rows) ? this->halo : 0;
+}
+
+int Decomposition::halo_above() const
+{
+    if (this->processes == 1)
+        return 0;
+    return (this->rank != this->processes - 1 || this->periodic_rows)
+               ? this->halo
+               : 0;
+}
+
+int Decomposition::strip_rows() const
+{
+    return this->strip_begin(this->rank + 1) - this->strip_begin(this->rank);
+}
+
+glm::uvec2 Decomposition::local_size() const
+{
+    return glm::uvec2(
+        this->size.x,
+        this->halo_below() + this->strip_rows() + this->halo_above()
+    );
+}
+
+int Decomposition::strip_begin(const int rank) const
+{
+    return this->size.y * rank / this->processes;
+}
+
+void Decomposition::arrive()
+{
+    ++this->synchronizations;
+    this->shared->arrivals.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Decomposition::wait()
+{
+    const std::uint64_t target = this->synchronizations * this->processes;
+    for (std::uint64_t i = 0;
+         this->shared->arrivals.load(std::memory_order_acquire) < target;
+         ++i)
+    {
+        // The arrivals are checked again, the processes may have
+        // arrived before the root left.
+        if (this->shared->abandoned.load(std::memory_order_acquire) &&
+            this->shared->arrivals.load(std::memory_order_acquire) < target)
+        {
+            this->fail();
+        }
+        if (this->is_root() && i % 1024 == 0 && this->child_failed())
+            this->fail();
+        std::this_thread::yield();
+    }
+}
+
+void Decomposition::fail()
+{
+    std::cerr << "A process of the decomposition failed." << std::endl;
+    if (this->is_root())
+    {
+        this->shared->abandoned.store(true, std::memory_order_release);
+        for (const pid_t child : this->children)
+            kill(child, SIGTERM);
+        for (const pid_t child : this->children)
+            waitpid(child, nullptr, 0);
+    }
+    std::_Exit(EXIT_FAILURE);
+}
+
+bool Decomposition::child_failed()
+{
+    for (auto child = this->children.begin(); child != this->children.end();)
+    {
+        int status;
+        if (waitpid(*child, &status, WNOHANG) != *child)
+        {
+            ++child;
+            continue;
+        }
+        // A child only finishes after the last synchronization point,
+        // which it has already arrived at.
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            this->children.erase(child);
+            return true;
+        }
+        child = this->children.erase(child);
+    }
+    return false;
+}
+
+void *Decomposition::halo_slot(
+    const int rank, const int side, const int parity
+) const
+{
+    const size_t slot_size = 2 * this->halo * this->size.x * sizeof(double);
+    const size_t index = (rank * 2 + side) * 2 + parity;
+    return reinterpret_cast<char *>(this->shared) + 64 + index * slot_size;
+}
+
+void *Decomposition::frame() const
+{
+    return this->halo_slot(this->processes, 0, 0);
+}
+
+size_t Decomposition::memory_size(
+    const glm::uvec2 size, const int processes, const int halo
+)
+{
+    const size_t halo_slots = processes * 2 * 2 * 2 * halo * size.x;
+    return 64 + (halo_slots + size.x * size.y) * sizeof(double);
+}
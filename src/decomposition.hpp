@@ -0,0 +1,349 @@
+#ifndef SIMULATION_VISUALIZATIONS_DECOMPOSITION_HPP
+#define SIMULATION_VISUALIZATIONS_DECOMPOSITION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <field.hpp>
+#include <memory>
+#include <optional>
+#include <sys/types.h>
+#include <vector>
+#include <wave_solver.hpp>
+
+namespace ev = elementary_visualizer;
+
+// Splits the rows of a grid into strips, each simulated by its own
+// process. The processes are forked from the root process, and
+// exchange the halo rows of the strips and gather the frames through
+// shared memory, so they run on the same machine.
+//
+// The processes end together: the children receive SIGTERM when the
+// root process dies, and when a process fails or leaves early, the
+// others exit with a failure at the next synchronization point instead
+// of waiting for it forever.
+//
+// The local field of a process holds the rows of its strip, plus
+// halo rows copied from the neighbouring strips on the sides
+// with neighbours; with periodic rows every strip has neighbours
+// on both sides.
+class Decomposition
+{
+public:
+
+    // Forks `processes - 1` child processes, and returns in all of
+    // them. Has to be called before creating any field, since the
+    // worker threads are not forked; the processes share the
+    // processors, see Workers::configure.
+    static ev::Expected<std::shared_ptr<Decomposition>, ev::Error> create(
+        const glm::uvec2 size,
+        const int processes,
+        const int halo,
+        const bool periodic_rows
+    );
+
+    // Waits for the child processes in the root process; children
+    // still waiting for the root fail.
+    ~Decomposition();
+
+    Decomposition(const Decomposition &) = delete;
+    Decomposition &operator=(const Decomposition &) = delete;
+
+    int get_rank() const
+    {
+        return this->rank;
+    }
+
+    bool is_root() const
+    {
+        return this->rank == 0;
+    }
+
+    // Number of halo rows below and above the strip.
+    int halo_below() const;
+
+    int halo_above() const;
+
+    // Number of rows of the strip of this process.
+    int strip_rows() const;
+
+    glm::uvec2 local_size() const;
+
+    // Local part of the field of the full grid.
+    template <typename T>
+    Field<T> scatter(const Field<T> &field) const;
+
+    // Exchange of the halo rows, split in two, so the interior can
+    // be computed while the neighbours send their rows. Every process
+    // has to take part in every exchange.
+    template <typename T>
+    void send_halos(const FieldState<T> &state);
+
+    template <typename T>
+    void receive_halos(FieldState<T> &state);
+
+    // Assembles the field of the full grid in the root process, the
+    // other processes return nothing. Every process has to take part.
+    template <typename T>
+    std::optional<Field<T>> gather(const Field<T> &field);
+
+private:
+
+    struct Shared
+    {
+        // Number of the arrivals of all of the processes at
+        // the synchronization points.
+        std::atomic<std::uint64_t> arrivals;
+        // Set when the root process leaves, or when it finds a failed
+        // child; no more arrivals are to be expected after it.
+        std::atomic<bool> abandoned;
+    };
+
+    Decomposition(
+        glm::uvec2 size,
+        int processes,
+        int halo,
+        bool periodic_rows,
+        void *memory,
+        size_t memory_size,
+        int rank,
+        std::vector<pid_t> children
+    );
+
+    // First row of the strip of `rank` in the full grid.
+    int strip_begin(const int rank) const;
+
+    // Arrives at the next synchronization point, and waits for all of
+    // the processes to arrive at it.
+    void arrive();
+
+    void wait();
+
+    // Ends the processes after a process failed.
+    [[noreturn]] void fail();
+
+    // Whether a child process failed; reaps the children which
+    // finished.
+    bool child_failed();
+
+    // Rows of amplitude and velocity sent by `rank` to the neighbour
+    // below (`side` 0) or above (`side` 1); the slots have room for
+    // the widest storage type.
+    void *halo_slot(const int rank, const int side, const int parity) const;
+
+    void *frame() const;
+
+    static size_t memory_size(
+        const glm::uvec2 size, const int processes, const int halo
+    );
+
+    glm::uvec2 size;
+    int processes;
+    int halo;
+    bool periodic_rows;
+    Shared *shared;
+    size_t shared_size;
+    int rank;
+    std::vector<pid_t> children;
+    // Number of synchronization points passed by this process.
+    std::uint64_t synchronizations;
+    int exchanges;
+};
+
+template <typename T>
+Field<T> Decomposition::scatter(const Field<T> &field) const
+{
+    const glm::uvec2 size = this->local_size();
+    const int offset = this->strip_begin(this->rank) - this->halo_below();
+    Field<T> local(size);
+    for (size_t y = 0; y != size.y; ++y)
+    {
+        for (size_t x = 0; x != size.x; ++x)
+            local(x, y) = field(x, offset + static_cast<int>(y));
+    }
+    return local;
+}
+
+template <typename T>
+void Decomposition::send_halos(const FieldState<T> &state)
+{
+    const int parity = this->exchanges % 2;
+    const size_t row_size = this->size.x;
+    const size_t values = this->halo * row_size;
+    const int below = this->halo_below();
+
+    // The rows of the strip next to its lower and upper edges.
+    const size_t first[2] = {
+        below * row_size, (below + this->strip_rows() - this->halo) * row_size
+    };
+    for (const int side : {0, 1})
+    {
+        if ((side == 0) ? (below == 0) : (this->halo_above() == 0))
+            continue;
+        T *slot = static_cast<T *>(this->halo_slot(this->rank, side, parity));
+        std::copy_n(state.amp.data() + first[side], values, slot);
+        std::copy_n(state.vel.data() + first[side], values, slot + values);
+    }
+
+    this->arrive();
+}
+
+template <typename T>
+void Decomposition::receive_halos(FieldState<T> &state)
+{
+    this->wait();
+
+    const int parity = this->exchanges % 2;
+    ++this->exchanges;
+
+    const size_t row_size = this->size.x;
+    const size_t values = this->halo * row_size;
+    const int below = this->halo_below();
+
+    auto receive = [&](const int neighbour, const int side, const int row)
+    {
+        const T *slot =
+            static_cast<const T *>(this->halo_slot(neighbour, side, parity));
+        std::copy_n(slot, values, state.amp.data() + row * row_size);
+        std::copy_n(slot + values, values, state.vel.data() + row * row_size);
+        const Region rows{
+            glm::ivec2(0, row), glm::ivec2(row_size, row + this->halo)
+        };
+        state.amp.set_region(state.amp.get_region().unite(rows));
+        state.vel.set_region(state.vel.get_region().unite(rows));
+    };
+
+    // The upper rows of the strip below, and the lower rows of the strip
+    // above.
+    if (below != 0)
+        receive((this->rank + this->processes - 1) % this->processes, 1, 0);
+    if (this->halo_above() != 0)
+    {
+        receive(
+            (this->rank + 1) % this->processes, 0, below + this->strip_rows()
+        );
+    }
+}
+
+template <typename T>
+std::optional<Field<T>> Decomposition::gather(const Field<T> &field)
+{
+    const size_t row_size = this->size.x;
+    std::copy_n(
+        field.data() + this->halo_below() * row_size,
+        this->strip_rows() * row_size,
+        static_cast<T *>(this->frame()) +
+            this->strip_begin(this->rank) * row_size
+    );
+    this->arrive();
+    this->wait();
+
+    std::optional<Field<T>> result;
+    if (this->is_root())
+    {
+        result.emplace(this->size);
+        std::copy_n(
+            static_cast<const T *>(this->frame()),
+            this->size.x * this->size.y,
+            result->data()
+        );
+    }
+
+    // The frame is not overwritten before the root has copied it.
+    this->arrive();
+    this->wait();
+    return result;
+}
+
+template <typename B, typename S, typename T>
+FieldState<T> strip_iteration(
+    FieldState<T> state,
+    const WaveParameters &parameters,
+    Decomposition &decomposition
+)
+{
+    decomposition.send_halos(state);
+
+    // The acceleration is computed while the neighbours send their
+    // halos; the rows next to the halos are computed again after
+    // receiving them.
+    Field<T> acc(state.amp.get_size());
+    wave_acceleration<B, S>(state, parameters, acc);
+
+    decomposition.receive_halos(state);
+
+    const int size_x = state.amp.get_size().x;
+    const int below = decomposition.halo_below();
+    const int rows = decomposition.strip_rows();
+    const LaplacianScales<accumulation_t<T>> scales(parameters);
+    Region updated = acc.get_region();
+    auto update_rows = [&](const int begin, const int end)
+    {
+        for (int y = begin; y < end; ++y)
+        {
+            for (int x = 0; x != size_x; ++x)
+            {
+                acc(x, y) = T(boundary_acceleration<B, S>(
+                    state, parameters, scales, x, y
+                ));
+            }
+        }
+        updated = updated.unite(
+            Region{glm::ivec2(0, begin), glm::ivec2(size_x, end)}
+        );
+    };
+    if (below != 0)
+        update_rows(below, below + S::radius);
+    if (decomposition.halo_above() != 0)
+        update_rows(below + rows - S::radius, below + rows);
+    acc.set_region(updated);
+
+    return FieldState<T>(state.vel, acc);
+}
+
+// Iteration of the wave equation on the local field of the process.
+// The rows of the strip next to a neighbour take their values from
+// the halo rows; beyond the halo rows any policy gives the same
+// result, as long as the halo is at least the stencil radius.
+template <typename B, typename S = SecondOrder, typename T>
+FieldState<T> decomposed_wave_iteration(
+    const FieldState<T> &state,
+    const WaveParameters &parameters,
+    Decomposition &decomposition
+)
+{
+    using X = Boundaries<
+        typename B::x_min,
+        typename B::x_max,
+        Dirichlet,
+        Dirichlet>;
+    const bool below = decomposition.halo_below() != 0;
+    const bool above = decomposition.halo_above() != 0;
+
+    if (below && above)
+        return strip_iteration<X, S>(state, parameters, decomposition);
+    if (below)
+    {
+        return strip_iteration<
+            Boundaries<
+                typename B::x_min,
+                typename B::x_max,
+                Dirichlet,
+                typename B::y_max>,
+            S>(state, parameters, decomposition);
+    }
+    if (above)
+    {
+        return strip_iteration<
+            Boundaries<
+                typename B::x_min,
+                typename B::x_max,
+                typename B::y_min,
+                Dirichlet>,
+            S>(state, parameters, decomposition);
+    }
+    return strip_iteration<B, S>(state, parameters, decomposition);
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include <cmath>
+#include <fft.hpp>
+#include <numbers>
+
+Fft::Fft(const size_t n) : n(n)
+{
+    size_t m = n;
+    for (size_t p = 2; p * p <= m; ++p)
+    {
+        while (m % p == 0)
+        {
+            this->factors.push_back(p);
+            m /= p;
+        }
+    }
+    if (m > 1)
+        this->factors.push_back(m);
+
+    this->twiddles.resize(n);
+    for (size_t j = 0; j != n; ++j)
+    {
+        const double phase = -2.0 * std::numbers::pi * j / n;
+        this->twiddles[j] = std::polar(1.0, phase);
+    }
+}
+
+void Fft::transform(
+    std::complex<double> *data, const size_t stride, const bool inverse
+) const
+{
+    std::vector<std::complex<double>> in(this->n);
+    for (size_t j = 0; j != this->n; ++j)
+        in[j] = data[j * stride];
+
+    std::vector<std::complex<double>> out(this->n);
+    this->transform_recursive(in.data(), out.data(), this->n, 1, 0, inverse);
+
+    for (size_t j = 0; j != this->n; ++j)
+        data[j * stride] = out[j];
+}
+
+void Fft::transform_recursive(
+    const std::complex<double> *in,
+    std::complex<double> *out,
+    const size_t n,
+    const size_t stride,
+    const size_t factor_index,
+    const bool inverse
+) const
+{
+    if (n == 1)
+    {
+        out[0] = in[0];
+        return;
+    }
+
+    // Decimation in time, the `p` subsequences of length `m`
+    // are transformed into consecutive blocks of the output.
+    const size_t p = this->factors[factor_index];
+    const size_t m = n / p;
+    for (size_t q = 0; q != p; ++q)
+    {
+        this->transform_recursive(
+            in + q * stride,
+            out + q * m,
+            m,
+            stride * p,
+            factor_index + 1,
+            inverse
+        );
+    }
+
+    // Twiddle of the current length n is the (this->n / n)-th power
+    // of the twiddle of the full length.
+    const size_t twiddle_step = this->n / n;
+    auto twiddle = [&](const size_t e)
+    {
+        const std::complex<double> w =
+            this->twiddles[(e * twiddle_step) % this->n];
+        return inverse ? std::conj(w) : w;
+    };
+
+    std::vector<std::complex<double>> block(p);
+    for (size_t k = 0; k != m; ++k)
+    {
+        for (size_t q = 0; q != p; ++q)
+            block[q] = out[q * m + k];
+
+        for (size_t r = 0; r != p; ++r)
+        {
+            const size_t k_out = k + r * m;
+            std::complex<double> sum = 0.0;
+            for (size_t q = 0; q != p; ++q)
+                sum += twiddle(q * k_out) * block[q];
+            out[k_out] = sum;
+        }
+    }
+}
+
+void fft_2d(
+    std::complex<double> *data,
+    const Fft &fft_x,
+    const Fft &fft_y,
+    const bool inverse
+)
+{
+    const size_t size_x = fft_x.size();
+    const size_t size_y = fft_y.size();
+    for (size_t y = 0; y != size_y; ++y)
+        fft_x.transform(data + y * size_x, 1, inverse);
+    for (size_t x = 0; x != size_x; ++x)
+        fft_y.transform(data + x, size_x, inverse);
+}
@@ -0,0 +1,54 @@
+#ifndef SIMULATION_VISUALIZATIONS_FFT_HPP
+#define SIMULATION_VISUALIZATIONS_FFT_HPP
+
+#include <complex>
+#include <vector>
+
+// Mixed radix fast Fourier transform of any length; the length is
+// factorized into primes, and the prime factors are transformed
+// directly, so lengths with small prime factors are fast.
+class Fft
+{
+public:
+
+    explicit Fft(const size_t n);
+
+    // Unnormalized in-place transform of the `n` elements of `data`,
+    // which are `stride` elements apart. The forward transform uses
+    // the exp(-2 pi i j k / n) kernel, the inverse exp(+2 pi i j k / n).
+    void transform(
+        std::complex<double> *data, const size_t stride, const bool inverse
+    ) const;
+
+    size_t size() const
+    {
+        return this->n;
+    }
+
+private:
+
+    void transform_recursive(
+        const std::complex<double> *in,
+        std::complex<double> *out,
+        const size_t n,
+        const size_t stride,
+        const size_t factor_index,
+        const bool inverse
+    ) const;
+
+    size_t n;
+    std::vector<size_t> factors;
+    // exp(-2 pi i j / n) for all j.
+    std::vector<std::complex<double>> twiddles;
+};
+
+// Two dimensional transform of row-major data, the x index is
+// the fastest changing one.
+void fft_2d(
+    std::complex<double> *data,
+    const Fft &fft_x,
+    const Fft &fft_y,
+    const bool inverse
+);
+
+#endif
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cmath>
+#include <field.hpp>
+#include <optional>
+
+bool Region::empty() const
+{
+    return this->max.x <= this->min.x || this->max.y <= this->min.y;
+}
+
+bool Region::contains(const int x, const int y) const
+{
+    return this->min.x <= x && x < this->max.x && this->min.y <= y &&
+           y < this->max.y;
+}
+
+Region Region::unite(const Region &other) const
+{
+    if (this->empty())
+        return other;
+    if (other.empty())
+        return *this;
+    return Region{
+        glm::ivec2(
+            std::min(this->min.x, other.min.x),
+            std::min(this->min.y, other.min.y)
+        ),
+        glm::ivec2(
+            std::max(this->max.x, other.max.x),
+            std::max(this->max.y, other.max.y)
+        )
+    };
+}
+
+Region Region::dilate(const int r) const
+{
+    if (this->empty())
+        return *this;
+    return Region{
+        glm::ivec2(this->min.x - r, this->min.y - r),
+        glm::ivec2(this->max.x + r, this->max.y + r)
+    };
+}
+
+glm::uvec2 Symmetry::reduced_size(const glm::uvec2 full_size) const
+{
+    return glm::uvec2(
+        this->mirror_x ? (full_size.x + 1) / 2 : full_size.x,
+        this->mirror_y ? (full_size.y + 1) / 2 : full_size.y
+    );
+}
+
+glm::uvec2 Symmetry::full_size(const glm::uvec2 reduced_size) const
+{
+    return glm::uvec2(
+        this->mirror_x ? 2 * reduced_size.x - 1 : reduced_size.x,
+        this->mirror_y ? 2 * reduced_size.y - 1 : reduced_size.y
+    );
+}
+
+glm::ivec2 Symmetry::offset(const glm::uvec2 reduced_size) const
+{
+    return glm::ivec2(
+        this->mirror_x ? reduced_size.x - 1 : 0,
+        this->mirror_y ? reduced_size.y - 1 : 0
+    );
+}
+
+float interp(float t, float min, float max, float t_min, float t_max)
+{
+    t = (t - t_min) / (t_max - t_min);
+    return min + (max - min) * t;
+}
+
+glm::vec4
+    to_color(float v, const std::vector<std::pair<float, glm::vec4>> &colormap)
+{
+    if (v < colormap[0].first)
+        return colormap[0].second;
+    if (v > colormap.back().first)
+        return colormap.back().second;
+
+    std::optional<std::pair<float, glm::vec4>> color_begin;
+    std::optional<std::pair<float, glm::vec4>> color_end;
+    for (const auto &color_value : colormap)
+    {
+        if (color_value.first <= v)
+        {
+            color_begin = color_value;
+        }
+        else if (!color_end)
+        {
+            color_end = color_value;
+            break;
+        }
+    }
+
+    if (color_begin && color_end)
+    {
+        return glm::vec4(
+            interp(
+                v,
+                color_begin->second.r,
+                color_end->second.r,
+                color_begin->first,
+                color_end->first
+            ),
+            interp(
+                v,
+                color_begin->second.g,
+                color_end->second.g,
+                color_begin->first,
+                color_end->first
+            ),
+            interp(
+                v,
+                color_begin->second.b,
+                color_end->second.b,
+                color_begin->first,
+                color_end->first
+            ),
+            interp(
+                v,
+                color_begin->second.a,
+                color_end->second.a,
+                color_begin->first,
+                color_end->first
+            )
+        );
+    }
+
+    return glm::vec4();
+}
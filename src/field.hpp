@@ -0,0 +1,465 @@
+#ifndef SIMULATION_VISUALIZATIONS_FIELD_HPP
+#define SIMULATION_VISUALIZATIONS_FIELD_HPP
+
+#include <algorithm>
+#include <buffer.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <functional>
+#include <scalar.hpp>
+#include <vector>
+#include <workers.hpp>
+
+namespace ev = elementary_visualizer;
+
+// Rectangle of cells; `min` is inclusive, `max` is exclusive.
+struct Region
+{
+    bool empty() const;
+
+    bool contains(const int x, const int y) const;
+
+    // Smallest region containing both of the regions.
+    Region unite(const Region &other) const;
+
+    // Region grown by `r` cells in every direction.
+    Region dilate(const int r) const;
+
+    glm::ivec2 min;
+    glm::ivec2 max;
+};
+
+// The field keeps track of the region outside of which all of its
+// values are zero; the arithmetic operators and the solvers only
+// process the cells inside of it. The region is the whole grid
+// by default, writing outside of the region after narrowing it
+// requires setting a new region.
+//
+// The rows of large fields are processed in parallel by the workers.
+//
+// The values are stored as T, which can be float, double, Half or
+// BFloat16; the arithmetic is carried out in accumulation_t<T>.
+// The narrow types halve the memory traffic of large grids, double
+// is meant for validating long runs. Half only reaches 65504, which
+// the accelerations of fine grids exceed, BFloat16 keeps the range
+// of float with less precision.
+template <typename T>
+class Field
+{
+public:
+
+    using value_type = T;
+
+    Field(size_t size_x, size_t size_y)
+        : size(glm::uvec2(size_x, size_y)),
+          region{glm::ivec2(0, 0), glm::ivec2(size_x, size_y)},
+          field(size_y, size_x, T(0.0f))
+    {}
+
+    Field(glm::uvec2 size)
+        : size(size),
+          region{glm::ivec2(0, 0), glm::ivec2(size)},
+          field(size.y, size.x, T(0.0f))
+    {}
+
+    // Converts the values of a field of another precision.
+    template <typename U>
+    explicit Field(const Field<U> &other)
+        : size(other.get_size()),
+          region(other.get_region()),
+          field(other.get_size().y, other.get_size().x, T(0.0f))
+    {
+        const U *data = other.data();
+        Workers::get().run(
+            this->size.y,
+            this->size.x,
+            [&](const size_t begin, const size_t end)
+            {
+                for (size_t i = begin * this->size.x; i != end * this->size.x;
+                     ++i)
+                {
+                    this->field[i] =
+                        T(static_cast<accumulation_t<U>>(data[i]));
+                }
+            }
+        );
+    }
+
+    size_t index(const int x, const int y) const
+    {
+        return Field::mod(y, this->size.y) * this->size.x +
+               Field::mod(x, this->size.x);
+    }
+
+    size_t index(const glm::ivec2 &i) const
+    {
+        return index(i.x, i.y);
+    }
+
+    T operator()(const int x, const int y) const
+    {
+        return this->field[this->index(x, y)];
+    }
+
+    T &operator()(const int x, const int y)
+    {
+        return this->field[this->index(x, y)];
+    }
+
+    glm::uvec2 get_size() const
+    {
+        return this->size;
+    }
+
+    const Region &get_region() const
+    {
+        return this->region;
+    }
+
+    // The values outside of the new region must be zero.
+    void set_region(const Region &region);
+
+    // Narrows the region to the bounding box of the values with larger
+    // magnitude than the tolerance, the values outside of the new
+    // region are set to zero.
+    void shrink_region(const float tolerance = 0.0f);
+
+    // Row-major storage, the x index is the fastest changing one;
+    // used by the solvers to access the cells without wrapping.
+    const T *data() const
+    {
+        return this->field.data();
+    }
+
+    T *data()
+    {
+        return this->field.data();
+    }
+
+private:
+
+    static size_t mod(int n, const int m)
+    {
+        n = n % m;
+        if (n < 0)
+            n += m;
+        return static_cast<size_t>(n);
+    }
+
+    glm::uvec2 size;
+    Region region;
+    Buffer<T> field;
+};
+
+// Mirror symmetry about the first column and/or the first row of the
+// field. The field only stores the cells from the symmetry axes
+// upwards; the full domain is twice as large minus the axis.
+struct Symmetry
+{
+    // Size of the field storing the full domain of `full_size`,
+    // the mirrored sizes must be odd.
+    glm::uvec2 reduced_size(const glm::uvec2 full_size) const;
+
+    glm::uvec2 full_size(const glm::uvec2 reduced_size) const;
+
+    // Position of the first stored cell in the full domain.
+    glm::ivec2 offset(const glm::uvec2 reduced_size) const;
+
+    // Stored cell of the full domain at (x, y).
+    glm::ivec2
+        cell(const glm::uvec2 reduced_size, const int x, const int y) const
+    {
+        const glm::ivec2 offset = this->offset(reduced_size);
+        return glm::ivec2(
+            this->mirror_x ? std::abs(x - offset.x) : x,
+            this->mirror_y ? std::abs(y - offset.y) : y
+        );
+    }
+
+    // Value of the full domain at (x, y).
+    template <typename T>
+    T operator()(const Field<T> &field, const int x, const int y) const
+    {
+        const glm::ivec2 cell = this->cell(field.get_size(), x, y);
+        return field(cell.x, cell.y);
+    }
+
+    bool mirror_x;
+    bool mirror_y;
+};
+
+template <typename T>
+void Field<T>::set_region(const Region &region)
+{
+    this->region = region;
+}
+
+template <typename T>
+void Field<T>::shrink_region(const float tolerance)
+{
+    Region active{glm::ivec2(0, 0), glm::ivec2(0, 0)};
+    for (int y = this->region.min.y; y < this->region.max.y; ++y)
+    {
+        const T *row = this->field.data() + y * this->size.x;
+        for (int x = this->region.min.x; x < this->region.max.x; ++x)
+        {
+            if (std::fabs(static_cast<accumulation_t<T>>(row[x])) > tolerance)
+            {
+                active = active.unite(Region{
+                    glm::ivec2(x, y), glm::ivec2(x + 1, y + 1)
+                });
+            }
+        }
+    }
+
+    for (int y = this->region.min.y; y < this->region.max.y; ++y)
+    {
+        T *row = this->field.data() + y * this->size.x;
+        for (int x = this->region.min.x; x < this->region.max.x; ++x)
+        {
+            if (!active.contains(x, y))
+                row[x] = T(0.0f);
+        }
+    }
+
+    this->region = active;
+}
+
+// Calls `task` for the ranges of the rows of the region, split
+// into the ranges of the rows of the workers.
+template <typename T, typename Task>
+void parallel_rows(const Field<T> &field, const Region &region, Task task)
+{
+    if (region.empty())
+        return;
+    Workers::get().run(
+        field.get_size().y,
+        region.max.x - region.min.x,
+        [&](const size_t begin, const size_t end)
+        {
+            const int y_begin = std::max<int>(begin, region.min.y);
+            const int y_end = std::min<int>(end, region.max.y);
+            if (y_begin < y_end)
+                task(y_begin, y_end);
+        }
+    );
+}
+
+template <typename T>
+Field<T> operator*(float c, Field<T> field)
+{
+    using A = accumulation_t<T>;
+    const Region region = field.get_region();
+    const size_t size_x = field.get_size().x;
+    parallel_rows(
+        field,
+        region,
+        [&](const int y_begin, const int y_end)
+        {
+            // Local copies, the stores cannot alias them.
+            const A factor = c;
+            const int x_begin = region.min.x;
+            const int x_end = region.max.x;
+            for (int y = y_begin; y < y_end; ++y)
+            {
+                T *data = field.data() + y * size_x;
+                for (int x = x_begin; x < x_end; ++x)
+                    data[x] = T(factor * static_cast<A>(data[x]));
+            }
+        }
+    );
+    return field;
+}
+
+template <typename T>
+Field<T> operator+(Field<T> field_0, const Field<T> &field_1)
+{
+    using A = accumulation_t<T>;
+    const Region region = field_1.get_region();
+    const size_t size_x = field_0.get_size().x;
+    parallel_rows(
+        field_0,
+        region,
+        [&](const int y_begin, const int y_end)
+        {
+            const int x_begin = region.min.x;
+            const int x_end = region.max.x;
+            for (int y = y_begin; y < y_end; ++y)
+            {
+                T *data_0 = field_0.data() + y * size_x;
+                const T *data_1 = field_1.data() + y * size_x;
+                for (int x = x_begin; x < x_end; ++x)
+                {
+                    data_0[x] = T(static_cast<A>(data_0[x]) +
+                                  static_cast<A>(data_1[x]));
+                }
+            }
+        }
+    );
+    field_0.set_region(field_0.get_region().unite(region));
+    return field_0;
+}
+
+// Averages of the blocks of `factor` by `factor` cells; the size of
+// the field must be divisible by the factor.
+template <typename T>
+Field<T> downsample(const Field<T> &field, const int factor)
+{
+    using A = accumulation_t<T>;
+    const glm::uvec2 size = field.get_size() / static_cast<unsigned>(factor);
+    Field<T> result(size);
+    for (size_t y = 0; y != size.y; ++y)
+    {
+        for (size_t x = 0; x != size.x; ++x)
+        {
+            A sum = 0;
+            for (int j = 0; j != factor; ++j)
+            {
+                for (int i = 0; i != factor; ++i)
+                {
+                    sum += static_cast<A>(
+                        field(factor * x + i, factor * y + j)
+                    );
+                }
+            }
+            result(x, y) = T(sum / A(factor * factor));
+        }
+    }
+    return result;
+}
+
+template <typename T>
+struct FieldState
+{
+    FieldState(const Field<T> &amp, const Field<T> &vel) : amp(amp), vel(vel)
+    {}
+
+    template <typename U>
+    explicit FieldState(const FieldState<U> &other)
+        : amp(other.amp), vel(other.vel)
+    {}
+
+    Field<T> amp;
+    Field<T> vel;
+};
+
+template <typename T>
+FieldState<T> operator*(float c, const FieldState<T> &field_state)
+{
+    return FieldState<T>(c * field_state.amp, c * field_state.vel);
+}
+
+// Narrows the regions of both the amplitude and the velocity;
+// the region of the wave grows by the stencil radius in every
+// Runge-Kutta stage, shrinking it after every iteration removes
+// the negligible numerical tails in front of the wavefront.
+template <typename T>
+void shrink_region(FieldState<T> &field_state, const float tolerance)
+{
+    field_state.amp.shrink_region(tolerance);
+    field_state.vel.shrink_region(tolerance);
+}
+
+template <typename T>
+FieldState<T> operator+(
+    const FieldState<T> &field_state_0, const FieldState<T> &field_state_1
+)
+{
+    return FieldState<T>(
+        field_state_0.amp + field_state_1.amp,
+        field_state_0.vel + field_state_1.vel
+    );
+}
+
+template <typename T>
+T runge_kutta_iteration(
+    const float t, const T &y, std::function<T(float, T)> f, const float h
+)
+{
+    T k_1 = f(t, y);
+    T k_2 = f(t + 0.5f * h, y + (0.5f * h) * k_1);
+    T k_3 = f(t + 0.5f * h, y + (0.5f * h) * k_2);
+    T k_4 = f(t + h, y + h * k_3);
+    return y + (h / 6.0f) * (k_1 + 2.0f * k_2 + 2.0f * k_3 + k_4);
+}
+
+// State at the fraction `s` of the time `h` between two states, from
+// the cubic Hermite polynomial of the amplitude through the amplitudes
+// of both states with their velocities as slopes; the velocity is its
+// derivative. Accurate to third order in `h` where the state is
+// smooth in time, unlike linear blending of the amplitudes, which
+// flattens the wave between the states.
+template <typename T>
+FieldState<T> hermite_interpolation(
+    const FieldState<T> &state_0,
+    const FieldState<T> &state_1,
+    const float h,
+    const float s
+)
+{
+    using A = accumulation_t<T>;
+    const Region region =
+        state_0.amp.get_region()
+            .unite(state_0.vel.get_region())
+            .unite(state_1.amp.get_region())
+            .unite(state_1.vel.get_region());
+    const size_t size_x = state_0.amp.get_size().x;
+    FieldState<T> result(
+        Field<T>(state_0.amp.get_size()), Field<T>(state_0.amp.get_size())
+    );
+    parallel_rows(
+        result.amp,
+        region,
+        [&](const int y_begin, const int y_end)
+        {
+            // Basis polynomials and their derivatives at `s`, the slopes
+            // are scaled to the unit interval.
+            const A s_2 = A(s) * A(s);
+            const A s_3 = s_2 * A(s);
+            const A h_00 = 2 * s_3 - 3 * s_2 + 1;
+            const A h_10 = A(h) * (s_3 - 2 * s_2 + A(s));
+            const A h_01 = -2 * s_3 + 3 * s_2;
+            const A h_11 = A(h) * (s_3 - s_2);
+            const A d_00 = (6 * s_2 - 6 * A(s)) / A(h);
+            const A d_10 = 3 * s_2 - 4 * A(s) + 1;
+            const A d_01 = (-6 * s_2 + 6 * A(s)) / A(h);
+            const A d_11 = 3 * s_2 - 2 * A(s);
+            const int x_begin = region.min.x;
+            const int x_end = region.max.x;
+            for (int y = y_begin; y < y_end; ++y)
+            {
+                const size_t row = y * size_x;
+                const T *amp_0 = state_0.amp.data() + row;
+                const T *vel_0 = state_0.vel.data() + row;
+                const T *amp_1 = state_1.amp.data() + row;
+                const T *vel_1 = state_1.vel.data() + row;
+                T *amp = result.amp.data() + row;
+                T *vel = result.vel.data() + row;
+                for (int x = x_begin; x < x_end; ++x)
+                {
+                    const A a_0 = static_cast<A>(amp_0[x]);
+                    const A v_0 = static_cast<A>(vel_0[x]);
+                    const A a_1 = static_cast<A>(amp_1[x]);
+                    const A v_1 = static_cast<A>(vel_1[x]);
+                    amp[x] =
+                        T(h_00 * a_0 + h_10 * v_0 + h_01 * a_1 + h_11 * v_1);
+                    vel[x] =
+                        T(d_00 * a_0 + d_10 * v_0 + d_01 * a_1 + d_11 * v_1);
+                }
+            }
+        }
+    );
+    result.amp.set_region(region);
+    result.vel.set_region(region);
+    return result;
+}
+
+float interp(
+    float t, float min, float max, float t_min = 0.0f, float t_max = 1.0f
+);
+
+glm::vec4
+    to_color(float v, const std::vector<std::pair<float, glm::vec4>> &colormap);
+
+#endif
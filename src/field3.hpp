@@ -0,0 +1,252 @@
+#ifndef SIMULATION_VISUALIZATIONS_FIELD3_HPP
+#define SIMULATION_VISUALIZATIONS_FIELD3_HPP
+
+#include <buffer.hpp>
+#include <cmath>
+#include <cstddef>
+#include <field.hpp>
+#include <glm/glm.hpp>
+#include <scalar.hpp>
+#include <workers.hpp>
+
+// Three dimensional grid of values, with periodic indexing like Field.
+// The planes of constant z are stored one after the other, each of them
+// row-major; the planes are split between the workers, see Buffer.
+// Unlike Field there is no active region, every cell is processed.
+template <typename T>
+class Field3
+{
+public:
+
+    using value_type = T;
+
+    Field3(size_t size_x, size_t size_y, size_t size_z)
+        : size(glm::uvec3(size_x, size_y, size_z)),
+          field(size_z, size_x * size_y, T(0.0f))
+    {}
+
+    Field3(glm::uvec3 size)
+        : size(size), field(size.z, size.x * size.y, T(0.0f))
+    {}
+
+    size_t index(const int x, const int y, const int z) const
+    {
+        return (Field3::mod(z, this->size.z) * this->size.y +
+                Field3::mod(y, this->size.y)) *
+                   this->size.x +
+               Field3::mod(x, this->size.x);
+    }
+
+    T operator()(const int x, const int y, const int z) const
+    {
+        return this->field[this->index(x, y, z)];
+    }
+
+    T &operator()(const int x, const int y, const int z)
+    {
+        return this->field[this->index(x, y, z)];
+    }
+
+    glm::uvec3 get_size() const
+    {
+        return this->size;
+    }
+
+    const T *data() const
+    {
+        return this->field.data();
+    }
+
+    T *data()
+    {
+        return this->field.data();
+    }
+
+private:
+
+    static size_t mod(int n, const int m)
+    {
+        n = n % m;
+        if (n < 0)
+            n += m;
+        return static_cast<size_t>(n);
+    }
+
+    glm::uvec3 size;
+    Buffer<T> field;
+};
+
+// Calls `task` with ranges of the planes of the field, in parallel.
+template <typename T, typename Task>
+void parallel_planes(const Field3<T> &field, const Task &task)
+{
+    const glm::uvec3 size = field.get_size();
+    Workers::get().run(size.z, size.x * size.y, task);
+}
+
+template <typename T>
+Field3<T> operator*(float c, Field3<T> field)
+{
+    using A = accumulation_t<T>;
+    const glm::uvec3 size = field.get_size();
+    const size_t plane_size = size.x * size.y;
+    parallel_planes(
+        field,
+        [&](const size_t begin, const size_t end)
+        {
+            const A factor = c;
+            T *data = field.data();
+            for (size_t i = begin * plane_size; i != end * plane_size; ++i)
+                data[i] = T(factor * static_cast<A>(data[i]));
+        }
+    );
+    return field;
+}
+
+template <typename T>
+Field3<T> operator+(Field3<T> field_0, const Field3<T> &field_1)
+{
+    using A = accumulation_t<T>;
+    const glm::uvec3 size = field_0.get_size();
+    const size_t plane_size = size.x * size.y;
+    parallel_planes(
+        field_0,
+        [&](const size_t begin, const size_t end)
+        {
+            T *data_0 = field_0.data();
+            const T *data_1 = field_1.data();
+            for (size_t i = begin * plane_size; i != end * plane_size; ++i)
+            {
+                data_0[i] =
+                    T(static_cast<A>(data_0[i]) + static_cast<A>(data_1[i]));
+            }
+        }
+    );
+    return field_0;
+}
+
+template <typename T>
+struct FieldState3
+{
+    FieldState3(const Field3<T> &amp, const Field3<T> &vel)
+        : amp(amp), vel(vel)
+    {}
+
+    Field3<T> amp;
+    Field3<T> vel;
+};
+
+template <typename T>
+FieldState3<T> operator*(float c, const FieldState3<T> &field_state)
+{
+    return FieldState3<T>(c * field_state.amp, c * field_state.vel);
+}
+
+template <typename T>
+FieldState3<T> operator+(
+    const FieldState3<T> &field_state_0, const FieldState3<T> &field_state_1
+)
+{
+    return FieldState3<T>(
+        field_state_0.amp + field_state_1.amp,
+        field_state_0.vel + field_state_1.vel
+    );
+}
+
+// Axes of a three dimensional field; the two dimensional fields
+// extracted along an axis keep the order of the other two axes.
+enum class Axis
+{
+    x,
+    y,
+    z
+};
+
+// Position in the field of the cell (u, v) of the plane orthogonal
+// to `axis` at `w`.
+inline glm::ivec3
+    plane_cell(const Axis axis, const int u, const int v, const int w)
+{
+    switch (axis)
+    {
+    case Axis::x:
+        return glm::ivec3(w, u, v);
+    case Axis::y:
+        return glm::ivec3(u, w, v);
+    default:
+        return glm::ivec3(u, v, w);
+    }
+}
+
+inline glm::uvec2 plane_size(const glm::uvec3 size, const Axis axis)
+{
+    switch (axis)
+    {
+    case Axis::x:
+        return glm::uvec2(size.y, size.z);
+    case Axis::y:
+        return glm::uvec2(size.x, size.z);
+    default:
+        return glm::uvec2(size.x, size.y);
+    }
+}
+
+inline int axis_size(const glm::uvec3 size, const Axis axis)
+{
+    switch (axis)
+    {
+    case Axis::x:
+        return size.x;
+    case Axis::y:
+        return size.y;
+    default:
+        return size.z;
+    }
+}
+
+// Plane of the field orthogonal to `axis` at the index `w`.
+template <typename T>
+Field<T> slice(const Field3<T> &field, const Axis axis, const int w)
+{
+    const glm::uvec2 size = plane_size(field.get_size(), axis);
+    Field<T> result(size);
+    for (size_t v = 0; v != size.y; ++v)
+    {
+        for (size_t u = 0; u != size.x; ++u)
+        {
+            const glm::ivec3 cell = plane_cell(axis, u, v, w);
+            result(u, v) = field(cell.x, cell.y, cell.z);
+        }
+    }
+    return result;
+}
+
+// Projection of the field along `axis`, each value is the one with
+// the largest magnitude along the line of cells; shows the wavefronts
+// of the whole volume as a height map.
+template <typename T>
+Field<T> projection(const Field3<T> &field, const Axis axis)
+{
+    using A = accumulation_t<T>;
+    const glm::uvec2 size = plane_size(field.get_size(), axis);
+    const int depth = axis_size(field.get_size(), axis);
+    Field<T> result(size);
+    for (size_t v = 0; v != size.y; ++v)
+    {
+        for (size_t u = 0; u != size.x; ++u)
+        {
+            A value = 0;
+            for (int w = 0; w != depth; ++w)
+            {
+                const glm::ivec3 cell = plane_cell(axis, u, v, w);
+                const A sample = static_cast<A>(field(cell.x, cell.y, cell.z));
+                if (std::abs(sample) > std::abs(value))
+                    value = sample;
+            }
+            result(u, v) = T(value);
+        }
+    }
+    return result;
+}
+
+#endif
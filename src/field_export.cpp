@@ -0,0 +1,139 @@
+#include <bit>
+#include <field_export.hpp>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+
+// The header is padded to a fixed size, so the number of frames can
+// be rewritten in place; the data starts aligned to 64 bytes.
+const size_t header_size = 128;
+
+}
+
+ev::Expected<std::shared_ptr<FieldExporter>, ev::Error> FieldExporter::create(
+    const std::string &file_name,
+    const Region &region,
+    const int stride,
+    const size_t buffered_frames
+)
+{
+    if (region.empty() || stride < 1 || buffered_frames < 1)
+        return ev::Unexpected<ev::Error>(ev::Error());
+
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return ev::Unexpected<ev::Error>(ev::Error());
+
+    std::shared_ptr<FieldExporter> exporter(new FieldExporter(
+        std::move(file), region, stride, buffered_frames
+    ));
+    if (!exporter->good())
+        return ev::Unexpected<ev::Error>(ev::Error());
+    return exporter;
+}
+
+FieldExporter::FieldExporter(
+    std::ofstream file,
+    const Region &region,
+    const int stride,
+    const size_t buffered_frames
+)
+    : file(std::move(file)),
+      region(region),
+      stride(stride),
+      buffered_frames(buffered_frames),
+      frames(0),
+      stop(false),
+      failed(false)
+{
+    this->write_header();
+    this->failed = !this->file;
+
+    this->thread = std::thread(
+        [this]()
+        {
+            std::unique_lock lock(this->mutex);
+            while (true)
+            {
+                this->queued.wait(
+                    lock,
+                    [this]() { return !this->queue.empty() || this->stop; }
+                );
+                if (this->queue.empty())
+                    return;
+                std::vector<float> frame = std::move(this->queue.front());
+                this->queue.pop_front();
+                this->written.notify_one();
+
+                lock.unlock();
+                this->file.write(
+                    reinterpret_cast<const char *>(frame.data()),
+                    frame.size() * sizeof(float)
+                );
+                lock.lock();
+                this->failed = this->failed || !this->file;
+                ++this->frames;
+            }
+        }
+    );
+}
+
+FieldExporter::~FieldExporter()
+{
+    {
+        std::lock_guard lock(this->mutex);
+        this->stop = true;
+    }
+    this->queued.notify_one();
+    this->thread.join();
+
+    this->file.seekp(0);
+    this->write_header();
+}
+
+bool FieldExporter::good() const
+{
+    std::lock_guard lock(this->mutex);
+    return !this->failed;
+}
+
+void FieldExporter::enqueue(std::vector<float> frame)
+{
+    {
+        std::unique_lock lock(this->mutex);
+        this->written.wait(
+            lock,
+            [this]() { return this->queue.size() < this->buffered_frames; }
+        );
+        this->queue.push_back(std::move(frame));
+    }
+    this->queued.notify_one();
+}
+
+void FieldExporter::write_header()
+{
+    const glm::uvec2 size = this->frame_size();
+    const bool little = std::endian::native == std::endian::little;
+    std::ostringstream dictionary;
+    dictionary << "{'descr': '" << (little ? '<' : '>')
+               << "f4', 'fortran_order': False, 'shape': (" << this->frames
+               << ", " << size.y << ", " << size.x << "), }";
+    // Magic string, version 1.0 and the length of the dictionary,
+    // which is padded with spaces and ends with a newline.
+    std::string header("\x93NUMPY\x01\x00", 8);
+    const size_t length = header_size - header.size() - 2;
+    header += static_cast<char>(length & 0xff);
+    header += static_cast<char>(length >> 8);
+    std::string padded = dictionary.str();
+    padded.resize(length - 1, ' ');
+    header += padded + '\n';
+    this->file.write(header.data(), header.size());
+}
+
+glm::uvec2 FieldExporter::frame_size() const
+{
+    const glm::ivec2 size = this->region.max - this->region.min;
+    return glm::uvec2((size + this->stride - 1) / this->stride);
+}
@@ -0,0 +1,101 @@
+#ifndef SIMULATION_VISUALIZATIONS_FIELD_EXPORT_HPP
+#define SIMULATION_VISUALIZATIONS_FIELD_EXPORT_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <field.hpp>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ev = elementary_visualizer;
+
+// Writes the values of a field in every frame to a NumPy .npy file of
+// float32 with the shape (frames, rows, columns), for analysis outside
+// of the scenes; numpy.load reads it, also memory mapped.
+//
+// The fields can be cropped to a region and decimated to every
+// `stride`-th cell of it. The frames are copied by the caller and
+// written by a background thread; at most `buffered_frames` frames
+// wait for it, after which the caller waits instead of buffering
+// without bound. The number of frames in the header is updated when
+// the exporter is destroyed.
+class FieldExporter
+{
+public:
+
+    static ev::Expected<std::shared_ptr<FieldExporter>, ev::Error> create(
+        const std::string &file_name,
+        const Region &region,
+        const int stride = 1,
+        const size_t buffered_frames = 16
+    );
+
+    // Writes the queued frames and completes the header.
+    ~FieldExporter();
+
+    FieldExporter(const FieldExporter &) = delete;
+    FieldExporter &operator=(const FieldExporter &) = delete;
+
+    // Queues the next frame; the field has to contain the region.
+    template <typename T>
+    void write(const Field<T> &field);
+
+    // False once writing to the file failed.
+    bool good() const;
+
+private:
+
+    FieldExporter(
+        std::ofstream file,
+        const Region &region,
+        const int stride,
+        const size_t buffered_frames
+    );
+
+    void enqueue(std::vector<float> frame);
+
+    void write_header();
+
+    glm::uvec2 frame_size() const;
+
+    std::ofstream file;
+    Region region;
+    int stride;
+    size_t buffered_frames;
+    mutable std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable written;
+    std::deque<std::vector<float>> queue;
+    size_t frames;
+    bool stop;
+    bool failed;
+    std::thread thread;
+};
+
+template <typename T>
+void FieldExporter::write(const Field<T> &field)
+{
+    const glm::uvec2 size = this->frame_size();
+    std::vector<float> frame(size.x * size.y);
+    for (size_t y = 0; y != size.y; ++y)
+    {
+        const T *row = field.data() +
+                       (this->region.min.y + y * this->stride) *
+                           field.get_size().x +
+                       this->region.min.x;
+        for (size_t x = 0; x != size.x; ++x)
+        {
+            frame[y * size.x + x] = static_cast<float>(
+                static_cast<accumulation_t<T>>(row[x * this->stride])
+            );
+        }
+    }
+    this->enqueue(std::move(frame));
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include <fcntl.h>
+#include <filesystem>
+#include <frame_cache.hpp>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+const std::uint64_t magic = 0x5349'4d46'5241'4d45;
+
+// FNV-1a, continuing from `hash`.
+std::uint64_t fnv_1a(
+    const char *data,
+    const size_t size,
+    std::uint64_t hash = 0xcbf2'9ce4'8422'2325
+)
+{
+    for (size_t i = 0; i != size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100'0000'01b3;
+    }
+    return hash;
+}
+
+// Hash of the parameters and of the executable, or nothing if
+// the executable cannot be read.
+std::optional<std::uint64_t> cache_hash(const std::string &parameters)
+{
+    std::ifstream executable("/proc/self/exe", std::ios::binary);
+    if (!executable)
+        return std::nullopt;
+    std::uint64_t hash = fnv_1a(parameters.data(), parameters.size());
+    std::vector<char> chunk(1 << 16);
+    while (executable)
+    {
+        executable.read(chunk.data(), chunk.size());
+        hash = fnv_1a(chunk.data(), executable.gcount(), hash);
+    }
+    return hash;
+}
+
+}
+
+ev::Expected<std::shared_ptr<FrameCache>, ev::Error> FrameCache::create(
+    const std::string &name,
+    const std::string &parameters,
+    const int frames,
+    const glm::uvec2 size,
+    const size_t value_size
+)
+{
+    const auto hash = cache_hash(parameters);
+    if (!hash)
+        return ev::Unexpected<ev::Error>(ev::Error());
+
+    std::ostringstream file_name;
+    file_name << name << "-" << std::hex << std::setw(16)
+              << std::setfill('0') << *hash << ".frames";
+    const std::filesystem::path directory("frame_cache");
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+        return ev::Unexpected<ev::Error>(ev::Error());
+    for (const auto &entry :
+         std::filesystem::directory_iterator(directory, error))
+    {
+        const std::string other = entry.path().filename().string();
+        if (other != file_name.str() && other.starts_with(name + "-") &&
+            other.ends_with(".frames"))
+        {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t frame_bytes = 2 * size.x * size.y * value_size;
+    const size_t frame_size = (frame_bytes + page - 1) / page * page;
+    // The header takes the first page.
+    const size_t memory_size = page + frames * frame_size;
+
+    const std::filesystem::path path = directory / file_name.str();
+    const int file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (file < 0)
+        return ev::Unexpected<ev::Error>(ev::Error());
+
+    const Header expected{
+        magic,
+        *hash,
+        static_cast<std::uint32_t>(frames),
+        size.x,
+        size.y,
+        static_cast<std::uint32_t>(value_size),
+        1
+    };
+    Header header{};
+    const bool complete =
+        pread(file, &header, sizeof(Header), 0) ==
+            static_cast<ssize_t>(sizeof(Header)) &&
+        std::memcmp(&header, &expected, sizeof(Header)) == 0 &&
+        lseek(file, 0, SEEK_END) == static_cast<off_t>(memory_size);
+    if (!complete)
+    {
+        // Discards the frames of an interrupted run; the new file is
+        // sparse until the frames are stored.
+        header = expected;
+        header.complete = 0;
+        if (ftruncate(file, 0) != 0 || ftruncate(file, memory_size) != 0 ||
+            pwrite(file, &header, sizeof(Header), 0) !=
+                static_cast<ssize_t>(sizeof(Header)))
+        {
+            close(file);
+            return ev::Unexpected<ev::Error>(ev::Error());
+        }
+    }
+
+    void *memory = mmap(
+        nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0
+    );
+    if (memory == MAP_FAILED)
+    {
+        close(file);
+        return ev::Unexpected<ev::Error>(ev::Error());
+    }
+    // The frames are mostly played in order.
+    madvise(memory, memory_size, MADV_SEQUENTIAL);
+
+    return std::shared_ptr<FrameCache>(
+        new FrameCache(memory, memory_size, page, frame_size, file, size)
+    );
+}
+
+FrameCache::FrameCache(
+    void *memory,
+    size_t memory_size,
+    size_t header_size,
+    size_t frame_size,
+    int file,
+    glm::uvec2 size
+)
+    : memory(static_cast<std::byte *>(memory)),
+      memory_size(memory_size),
+      header_size(header_size),
+      frame_size(frame_size),
+      file(file),
+      size(size)
+{}
+
+FrameCache::~FrameCache()
+{
+    munmap(this->memory, this->memory_size);
+    close(this->file);
+}
+
+bool FrameCache::is_complete() const
+{
+    return reinterpret_cast<const Header *>(this->memory)->complete != 0;
+}
+
+void FrameCache::complete()
+{
+    // The frames have to reach the file before the header claims them.
+    msync(this->memory, this->memory_size, MS_SYNC);
+    reinterpret_cast<Header *>(this->memory)->complete = 1;
+    msync(this->memory, sizeof(Header), MS_SYNC);
+}
+
+std::byte *FrameCache::frame_data(const int frame) const
+{
+    return this->memory + this->header_size + frame * this->frame_size;
+}
@@ -0,0 +1,112 @@
+#ifndef SIMULATION_VISUALIZATIONS_FRAME_CACHE_HPP
+#define SIMULATION_VISUALIZATIONS_FRAME_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <field.hpp>
+#include <memory>
+#include <string>
+
+namespace ev = elementary_visualizer;
+
+// Simulated frames kept on disk, so later runs of the same binary with
+// the same parameters map them instead of simulating them again.
+//
+// The file is named by a hash of a description of the parameters and
+// of the contents of the executable, any rebuild invalidates it. Every
+// frame starts at a page boundary and holds the amplitude and then
+// the velocity, row by row. The file is mapped shared: the stored
+// frames go to the page cache without buffering them in the process,
+// and the loaded frames are paged in on demand, so runs with more
+// frames than memory work.
+class FrameCache
+{
+public:
+
+    // Maps the cache file `frame_cache/<name>-<hash>.frames`; the files
+    // of the same name with another hash are removed. The file is
+    // recreated unless an earlier run completed it, see is_complete.
+    static ev::Expected<std::shared_ptr<FrameCache>, ev::Error> create(
+        const std::string &name,
+        const std::string &parameters,
+        const int frames,
+        const glm::uvec2 size,
+        const size_t value_size
+    );
+
+    ~FrameCache();
+
+    FrameCache(const FrameCache &) = delete;
+    FrameCache &operator=(const FrameCache &) = delete;
+
+    // True when all of the frames were stored and completed.
+    bool is_complete() const;
+
+    // Writes the stored frames to the file and marks them complete.
+    void complete();
+
+    // The type must have the value size of the cache.
+    template <typename T>
+    void store(const int frame, const FieldState<T> &state);
+
+    template <typename T>
+    FieldState<T> load(const int frame) const;
+
+private:
+
+    struct Header
+    {
+        std::uint64_t magic;
+        std::uint64_t hash;
+        std::uint32_t frames;
+        std::uint32_t size_x;
+        std::uint32_t size_y;
+        std::uint32_t value_size;
+        // Set last, after the frames reached the file.
+        std::uint64_t complete;
+    };
+
+    FrameCache(
+        void *memory,
+        size_t memory_size,
+        size_t header_size,
+        size_t frame_size,
+        int file,
+        glm::uvec2 size
+    );
+
+    std::byte *frame_data(const int frame) const;
+
+    std::byte *memory;
+    size_t memory_size;
+    // The header takes the first page, the frames follow.
+    size_t header_size;
+    // Bytes between the frames, a multiple of the page size.
+    size_t frame_size;
+    int file;
+    glm::uvec2 size;
+};
+
+template <typename T>
+void FrameCache::store(const int frame, const FieldState<T> &state)
+{
+    const size_t bytes = this->size.x * this->size.y * sizeof(T);
+    std::byte *data = this->frame_data(frame);
+    std::memcpy(data, state.amp.data(), bytes);
+    std::memcpy(data + bytes, state.vel.data(), bytes);
+}
+
+template <typename T>
+FieldState<T> FrameCache::load(const int frame) const
+{
+    const size_t bytes = this->size.x * this->size.y * sizeof(T);
+    const std::byte *data = this->frame_data(frame);
+    FieldState<T> state{Field<T>(this->size), Field<T>(this->size)};
+    std::memcpy(state.amp.data(), data, bytes);
+    std::memcpy(state.vel.data(), data + bytes, bytes);
+    return state;
+}
+
+#endif
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <frame_store.hpp>
+#include <utility>
+
+namespace
+{
+
+void write_varint(std::vector<std::uint8_t> &bytes, std::uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint32_t read_varint(const std::uint8_t *&bytes)
+{
+    std::uint32_t value = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        const std::uint8_t byte = *bytes++;
+        value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+        if (byte < 0x80)
+            return value;
+    }
+}
+
+std::uint32_t zigzag(const std::int32_t value)
+{
+    return (static_cast<std::uint32_t>(value) << 1) ^
+           static_cast<std::uint32_t>(value >> 31);
+}
+
+std::int32_t unzigzag(const std::uint32_t value)
+{
+    return static_cast<std::int32_t>(value >> 1) ^
+           -static_cast<std::int32_t>(value & 1);
+}
+
+template <typename T>
+void append(std::vector<std::byte> &bytes, const T &value)
+{
+    const std::byte *begin = reinterpret_cast<const std::byte *>(&value);
+    bytes.insert(bytes.end(), begin, begin + sizeof(T));
+}
+
+// Reads the value at the offset and moves past it, failing past the
+// end of the bytes.
+template <typename T>
+bool read(const std::vector<std::byte> &bytes, size_t &offset, T &value)
+{
+    if (sizeof(T) > bytes.size() - offset)
+        return false;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+// Largest quantized value; the predictions from the two frames before,
+// and the differences to them, stay within 32 bits.
+const std::int32_t max_quantized = 1 << 28;
+
+// Quantized value, clamped to the largest one; NaN is zero.
+std::int32_t quantize(const float value, const float scale, bool &clamped)
+{
+    const float scaled = value * scale;
+    const float limit = static_cast<float>(max_quantized);
+    clamped = !(std::fabs(scaled) <= limit);
+    if (clamped)
+        return std::isnan(scaled) ? 0
+               : scaled < 0.0f    ? -max_quantized
+                                  : max_quantized;
+    return static_cast<std::int32_t>(std::lround(scaled));
+}
+
+// Prediction of a quantized value from the two frames before it;
+// `index` is the position of the frame after its keyframe.
+std::int32_t predict(
+    const int index, const std::int32_t last, const std::int32_t before_last
+)
+{
+    if (index == 0)
+        return 0;
+    if (index == 1)
+        return last;
+    return 2 * last - before_last;
+}
+
+}
+
+CompressedFrames::CompressedFrames(
+    const glm::uvec2 size, const float step, const int keyframe_interval
+)
+    : field_size(size),
+      step(step),
+      keyframe_interval(keyframe_interval),
+      last(size.x * size.y, 0),
+      before_last(size.x * size.y, 0),
+      clamped_values(0),
+      restored_frame(-1),
+      restored_values(size.x * size.y, 0),
+      restored_previous(size.x * size.y, 0),
+      restored(size)
+{}
+
+void CompressedFrames::push_back(const Field<float> &field)
+{
+    const int index = this->frames.size() % this->keyframe_interval;
+    const float scale = 1.0f / this->step;
+    const float *data = field.data();
+    std::vector<std::uint8_t> bytes;
+    std::uint32_t zeros = 0;
+    for (size_t i = 0; i != this->last.size(); ++i)
+    {
+        bool clamped;
+        const std::int32_t value = quantize(data[i], scale, clamped);
+        this->clamped_values += clamped;
+        const std::int32_t difference =
+            value - predict(index, this->last[i], this->before_last[i]);
+        this->before_last[i] = this->last[i];
+        this->last[i] = value;
+        if (difference == 0)
+        {
+            ++zeros;
+            continue;
+        }
+        write_varint(bytes, zeros);
+        write_varint(bytes, zigzag(difference));
+        zeros = 0;
+    }
+    write_varint(bytes, zeros);
+    bytes.shrink_to_fit();
+    this->frames.push_back(std::move(bytes));
+}
+
+const Field<float> &CompressedFrames::get(const int frame) const
+{
+    if (frame == this->restored_frame)
+        return this->restored;
+
+    const int keyframe = frame / this->keyframe_interval *
+                         this->keyframe_interval;
+    const bool continues =
+        keyframe <= this->restored_frame && this->restored_frame < frame;
+    for (int i = continues ? this->restored_frame + 1 : keyframe; i <= frame;
+         ++i)
+    {
+        this->decode(i);
+    }
+    this->restored_frame = frame;
+
+    float *data = this->restored.data();
+    for (size_t i = 0; i != this->restored_values.size(); ++i)
+        data[i] = this->step * static_cast<float>(this->restored_values[i]);
+    return this->restored;
+}
+
+size_t CompressedFrames::bytes() const
+{
+    size_t bytes = 0;
+    for (const auto &frame : this->frames)
+        bytes += frame.size();
+    return bytes;
+}
+
+void CompressedFrames::save(std::vector<std::byte> &bytes) const
+{
+    append(bytes, this->field_size);
+    append(bytes, this->step);
+    append(bytes, static_cast<std::int32_t>(this->keyframe_interval));
+    append(bytes, static_cast<std::uint64_t>(this->clamped_values));
+    append(bytes, static_cast<std::uint32_t>(this->frames.size()));
+    for (const auto &frame : this->frames)
+    {
+        append(bytes, static_cast<std::uint64_t>(frame.size()));
+        const std::byte *begin = reinterpret_cast<const std::byte *>(
+            frame.data()
+        );
+        bytes.insert(bytes.end(), begin, begin + frame.size());
+    }
+}
+
+bool CompressedFrames::restore(
+    const std::vector<std::byte> &bytes, size_t &offset
+)
+{
+    glm::uvec2 size;
+    float step;
+    std::int32_t keyframe_interval;
+    std::uint64_t clamped_values;
+    std::uint32_t count;
+    if (!read(bytes, offset, size) || size != this->field_size ||
+        !read(bytes, offset, step) || step != this->step ||
+        !read(bytes, offset, keyframe_interval) ||
+        keyframe_interval != this->keyframe_interval ||
+        !read(bytes, offset, clamped_values) || !read(bytes, offset, count))
+    {
+        return false;
+    }
+
+    std::vector<std::vector<std::uint8_t>> frames(count);
+    for (auto &frame : frames)
+    {
+        std::uint64_t frame_size;
+        if (!read(bytes, offset, frame_size) ||
+            frame_size > bytes.size() - offset)
+        {
+            return false;
+        }
+        frame.resize(frame_size);
+        std::memcpy(frame.data(), bytes.data() + offset, frame_size);
+        offset += frame_size;
+    }
+
+    this->frames = std::move(frames);
+    this->clamped_values = clamped_values;
+    this->restored_frame = -1;
+    std::fill(this->last.begin(), this->last.end(), 0);
+    std::fill(this->before_last.begin(), this->before_last.end(), 0);
+    if (!this->frames.empty())
+    {
+        // The last two frames are predicted from, restoring the last one
+        // restores both.
+        this->get(this->size() - 1);
+        this->last = this->restored_values;
+        this->before_last = this->restored_previous;
+    }
+    return true;
+}
+
+void CompressedFrames::decode(const int frame) const
+{
+    const int index = frame % this->keyframe_interval;
+    auto &values = this->restored_values;
+    auto &previous = this->restored_previous;
+    for (size_t i = 0; i != values.size(); ++i)
+    {
+        const std::int32_t value = values[i];
+        values[i] = predict(index, value, previous[i]);
+        previous[i] = value;
+    }
+
+    const std::uint8_t *bytes = this->frames[frame].data();
+    const size_t size = values.size();
+    size_t i = read_varint(bytes);
+    while (i < size)
+    {
+        values[i] += unzigzag(read_varint(bytes));
+        i += 1 + read_varint(bytes);
+    }
+}
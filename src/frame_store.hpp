@@ -0,0 +1,86 @@
+#ifndef SIMULATION_VISUALIZATIONS_FRAME_STORE_HPP
+#define SIMULATION_VISUALIZATIONS_FRAME_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <field.hpp>
+#include <vector>
+
+// Frames of a field kept compressed in memory. The values are
+// quantized to multiples of `step`, so they are restored within half
+// of it; only values within 2^28 steps of zero are kept, larger ones
+// are clamped to that, and counted, and NaN is kept as zero. Every
+// frame is stored as the difference of its quantized
+// values to their linear extrapolation from the two frames before it;
+// every `keyframe_interval`-th frame is stored as the difference to
+// zero, and the frame after it as the difference to the keyframe, so
+// any frame is restored from at most that many frames.
+//
+// The differences are mostly zero, outside of the wavefronts and in
+// the quiescent regions, and small elsewhere, since the waves change
+// smoothly in time: they are encoded as the lengths of the runs of
+// zeros and the other differences, as variable length integers,
+// the signs moved to the lowest bit.
+class CompressedFrames
+{
+public:
+
+    CompressedFrames(
+        const glm::uvec2 size, const float step, const int keyframe_interval
+    );
+
+    void push_back(const Field<float> &field);
+
+    // Restores the frame; continues from the frame restored last when
+    // it lies between the frame and its keyframe, so the frames are
+    // restored one difference at a time when played in order. The
+    // field is valid until the next call.
+    const Field<float> &get(const int frame) const;
+
+    int size() const
+    {
+        return static_cast<int>(this->frames.size());
+    }
+
+    // Number of values pushed outside of the range of the steps, or NaN.
+    size_t clamped() const
+    {
+        return this->clamped_values;
+    }
+
+    // Bytes of the encoded frames.
+    size_t bytes() const;
+
+    // Appends the encoded frames to `bytes`, for a checkpoint.
+    void save(std::vector<std::byte> &bytes) const;
+
+    // Replaces the frames by those saved at `offset` of `bytes`, and
+    // moves the offset past them; the frames pushed later continue
+    // them. False when they were saved with another size, step or
+    // keyframe interval, or are damaged.
+    bool restore(const std::vector<std::byte> &bytes, size_t &offset);
+
+private:
+
+    // Restores the quantized values of the frame from those of the two
+    // frames before it.
+    void decode(const int frame) const;
+
+    glm::uvec2 field_size;
+    float step;
+    int keyframe_interval;
+    std::vector<std::vector<std::uint8_t>> frames;
+    // Quantized values of the last two frames pushed.
+    std::vector<std::int32_t> last;
+    std::vector<std::int32_t> before_last;
+    size_t clamped_values;
+
+    // The frame restored last, and the quantized values of it and of
+    // the frame before it.
+    mutable int restored_frame;
+    mutable std::vector<std::int32_t> restored_values;
+    mutable std::vector<std::int32_t> restored_previous;
+    mutable Field<float> restored;
+};
+
+#endif
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <framework.hpp>
 #include <iostream>
+#include <utility>
 
 std::string seconds_format(const long seconds)
 {
@@ -96,9 +98,11 @@ ev::Expected<std::shared_ptr<Framework>, ev::Error> Framework::create(
         return ev::Unexpected<ev::Error>(ev::Error());
 
     return std::shared_ptr<Framework>(new Framework(
-        file_name,
-        bit_rate,
+        VideoOutput{file_name, video_size, bit_rate, AV_CODEC_ID_VP9},
         std::move(video_scene.value()),
+        background_color,
+        samples_video,
+        depth_peeling_passes_video,
         std::move(window_scene.value()),
         std::move(window.value()),
         slider_position,
@@ -110,8 +114,41 @@ ev::Expected<std::shared_ptr<Framework>, ev::Error> Framework::create(
 
 void Framework::add_visual(std::shared_ptr<ev::Visual> visual)
 {
-    this->video_scene->add_visual(visual);
+    for (const auto &scene : this->video_scenes())
+        scene->add_visual(visual);
     this->window_scene->add_visual(visual);
+    this->visuals.push_back(visual);
+}
+
+ev::Expected<void, ev::Error> Framework::add_output(const VideoOutput &output)
+{
+    for (const auto &other : this->outputs)
+    {
+        if (other.video.size == output.size)
+        {
+            this->outputs.push_back(Output{output, other.scene});
+            return {};
+        }
+    }
+
+    ev::Expected<std::shared_ptr<ev::Scene>, ev::Error> scene =
+        ev::Scene::create(
+            output.size,
+            this->background_color,
+            this->samples_video,
+            this->depth_peeling_passes_video
+        );
+    if (!scene)
+        return ev::Unexpected<ev::Error>(ev::Error());
+    for (const auto &visual : this->visuals)
+        scene.value()->add_visual(visual);
+    this->outputs.push_back(Output{output, scene.value()});
+    return {};
+}
+
+void Framework::set_preview(std::function<bool(const int)> is_preview)
+{
+    this->is_preview = std::move(is_preview);
 }
 
 int Framework::run(
@@ -125,9 +162,20 @@ int Framework::run(
         run_function(this->frame, this->frames, this->t());
 
         this->window->render(this->window_scene->render());
-        if (this->recording)
+        // Only the full resolution frames are recorded.
+        const bool preview = this->is_preview && this->is_preview(this->frame);
+        if (this->recording && !preview)
         {
-            this->recording.value().video->render(this->video_scene->render());
+            // Every scene renders the frame once, for all of its outputs.
+            for (const auto &scene : this->video_scenes())
+            {
+                const std::shared_ptr<const ev::Image> image = scene->render();
+                for (size_t i = 0; i != this->outputs.size(); ++i)
+                {
+                    if (this->outputs[i].scene == scene)
+                        this->recording.value().videos[i]->render(image);
+                }
+            }
             if ((this->frame + 1) >= this->frames)
             {
                 std::cout << std::endl;
@@ -147,7 +195,11 @@ int Framework::run(
 }
 
 Framework::Framework(Framework &&other)
-    : video_scene(std::move(other.video_scene)),
+    : outputs(std::move(other.outputs)),
+      background_color(other.background_color),
+      samples_video(other.samples_video),
+      depth_peeling_passes_video(other.depth_peeling_passes_video),
+      visuals(std::move(other.visuals)),
       window_scene(std::move(other.window_scene)),
       window(std::move(other.window)),
       slider_position(other.slider_position),
@@ -156,6 +208,7 @@ Framework::Framework(Framework &&other)
       frame_rate(other.frame_rate),
       recording(other.recording),
       frame(other.frame),
+      is_preview(std::move(other.is_preview)),
       mouse_position(other.mouse_position)
 {
     this->setup_events();
@@ -163,7 +216,11 @@ Framework::Framework(Framework &&other)
 
 Framework &Framework::operator=(Framework &&other)
 {
-    this->video_scene = std::move(other.video_scene);
+    this->outputs = std::move(other.outputs);
+    this->background_color = other.background_color;
+    this->samples_video = other.samples_video;
+    this->depth_peeling_passes_video = other.depth_peeling_passes_video;
+    this->visuals = std::move(other.visuals);
     this->window_scene = std::move(other.window_scene);
     this->window = std::move(other.window);
     this->slider_position = other.slider_position;
@@ -172,6 +229,7 @@ Framework &Framework::operator=(Framework &&other)
     this->frame_rate = other.frame_rate;
     this->recording = other.recording;
     this->frame = other.frame;
+    this->is_preview = std::move(other.is_preview);
     this->mouse_position = other.mouse_position;
 
     this->setup_events();
@@ -180,9 +238,11 @@ Framework &Framework::operator=(Framework &&other)
 }
 
 Framework::Framework(
-    std::string file_name,
-    unsigned int bit_rate,
+    VideoOutput video,
     std::shared_ptr<ev::Scene> video_scene,
+    glm::vec4 background_color,
+    std::optional<int> samples_video,
+    int depth_peeling_passes_video,
     std::shared_ptr<ev::Scene> window_scene,
     std::shared_ptr<ev::Window> window,
     int slider_position,
@@ -190,9 +250,10 @@ Framework::Framework(
     int frames,
     int frame_rate
 )
-    : file_name(file_name),
-      bit_rate(bit_rate),
-      video_scene(video_scene),
+    : outputs{Output{std::move(video), video_scene}},
+      background_color(background_color),
+      samples_video(samples_video),
+      depth_peeling_passes_video(depth_peeling_passes_video),
       window_scene(window_scene),
       window(std::move(window)),
       slider_position(slider_position),
@@ -201,6 +262,7 @@ Framework::Framework(
       frame_rate(frame_rate),
       recording(std::nullopt),
       frame(0),
+      is_preview(nullptr),
       slider_drag(false),
       mouse_position(0.0f)
 {
@@ -223,19 +285,26 @@ void Framework::setup_events()
             {
                 if (!this->recording)
                 {
-                    ev::Expected<std::shared_ptr<ev::Video>, ev::Error> video =
-                        ev::Video::create(
-                            this->file_name,
-                            this->video_scene->get_size(),
-                            this->frame_rate,
-                            this->bit_rate,
-                            AV_CODEC_ID_VP9,
-                            false
-                        );
-                    if (video)
+                    std::vector<std::shared_ptr<ev::Video>> videos;
+                    for (const auto &output : this->outputs)
+                    {
+                        ev::Expected<std::shared_ptr<ev::Video>, ev::Error>
+                            video = ev::Video::create(
+                                output.video.file_name,
+                                output.video.size,
+                                this->frame_rate,
+                                output.video.bit_rate,
+                                output.video.codec,
+                                false
+                            );
+                        if (!video)
+                            break;
+                        videos.push_back(video.value());
+                    }
+                    if (videos.size() == this->outputs.size())
                     {
                         this->recording = Recording(
-                            {video.value(), std::chrono::system_clock::now()}
+                            {videos, std::chrono::system_clock::now()}
                         );
                         this->frame = 0;
                         this->slider_drag = false;
@@ -315,6 +384,8 @@ void Framework::update_slider()
 {
     if (this->recording)
         this->slider->color_0 = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+    else if (this->is_preview && this->is_preview(this->frame))
+        this->slider->color_0 = glm::vec4(0.9f, 0.6f, 0.1f, 1.0f);
     else
         this->slider->color_0 = glm::vec4(0.1f, 0.3f, 0.8f, 1.0f);
 
@@ -322,6 +393,20 @@ void Framework::update_slider()
     this->slider->update();
 }
 
+std::vector<std::shared_ptr<ev::Scene>> Framework::video_scenes() const
+{
+    std::vector<std::shared_ptr<ev::Scene>> scenes;
+    for (const auto &output : this->outputs)
+    {
+        if (std::find(scenes.begin(), scenes.end(), output.scene) ==
+            scenes.end())
+        {
+            scenes.push_back(output.scene);
+        }
+    }
+    return scenes;
+}
+
 float Framework::t() const
 {
     return static_cast<float>(this->frame) / (this->frames - 1);
@@ -11,9 +11,20 @@ void print_progress(
     const float t, const std::chrono::system_clock::time_point start_time
 );
 
+// Video recorded from the frames, with its own size, bit rate and
+// codec, such as AV_CODEC_ID_VP9.
+struct VideoOutput
+{
+    std::string file_name;
+    glm::uvec2 size;
+    unsigned int bit_rate;
+    int codec;
+};
+
 struct Recording
 {
-    std::shared_ptr<ev::Video> video;
+    // Video of every output.
+    std::vector<std::shared_ptr<ev::Video>> videos;
     std::chrono::system_clock::time_point start_time;
 };
 
@@ -37,6 +48,18 @@ public:
 
     void add_visual(std::shared_ptr<ev::Visual> visual);
 
+    // Records the frames also to another video, in the same pass over
+    // the frames. The outputs of the same size share the rendering of
+    // the frames; the frames are rendered once more for every other
+    // size, with the settings of the main video, since the rendered
+    // images cannot be scaled.
+    ev::Expected<void, ev::Error> add_output(const VideoOutput &output);
+
+    // Marks the frames only available as a preview, see
+    // ProgressiveFrames; the slider is shown in a different color
+    // while they are shown, and recording waits for the full frames.
+    void set_preview(std::function<bool(const int)> is_preview);
+
     int run(
         std::function<void(const int, const int, const float)> run_function
     );
@@ -50,10 +73,19 @@ public:
 
 private:
 
+    // Scene rendering the frames of a video output.
+    struct Output
+    {
+        VideoOutput video;
+        std::shared_ptr<ev::Scene> scene;
+    };
+
     Framework(
-        std::string file_name,
-        unsigned int bit_rate,
+        VideoOutput video,
         std::shared_ptr<ev::Scene> video_scene,
+        glm::vec4 background_color,
+        std::optional<int> samples_video,
+        int depth_peeling_passes_video,
         std::shared_ptr<ev::Scene> window_scene,
         std::shared_ptr<ev::Window> window,
         int slider_position,
@@ -68,11 +100,17 @@ private:
 
     void update_slider();
 
+    // Scenes of the outputs, each once.
+    std::vector<std::shared_ptr<ev::Scene>> video_scenes() const;
+
     float t() const;
 
-    std::string file_name;
-    unsigned int bit_rate;
-    std::shared_ptr<ev::Scene> video_scene;
+    // The main video first.
+    std::vector<Output> outputs;
+    glm::vec4 background_color;
+    std::optional<int> samples_video;
+    int depth_peeling_passes_video;
+    std::vector<std::shared_ptr<ev::Visual>> visuals;
     std::shared_ptr<ev::Scene> window_scene;
     std::shared_ptr<ev::Window> window;
     int slider_position;
@@ -81,6 +119,7 @@ private:
     int frame_rate;
     std::optional<Recording> recording;
     int frame;
+    std::function<bool(const int)> is_preview;
     bool slider_drag;
     glm::vec2 mouse_position;
 };
@@ -0,0 +1,21 @@
+#include <grid_surface.hpp>
+#include <utility>
+
+GridSurface::GridSurface(
+    std::vector<glm::vec3> positions,
+    std::vector<size_t> sources,
+    const size_t width,
+    const ev::SurfaceMode mode
+)
+    : sources(std::move(sources)),
+      width(width),
+      mode(mode),
+      heights(positions.size()),
+      vertices(positions.size())
+{
+    for (size_t i = 0; i != positions.size(); ++i)
+    {
+        this->heights[i] = positions[i].z;
+        this->vertices[i] = ev::Vertex(positions[i], glm::vec4(1.0f));
+    }
+}
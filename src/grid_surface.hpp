@@ -0,0 +1,55 @@
+#ifndef SIMULATION_VISUALIZATIONS_GRID_SURFACE_HPP
+#define SIMULATION_VISUALIZATIONS_GRID_SURFACE_HPP
+
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <vector>
+
+namespace ev = elementary_visualizer;
+
+// Grid of vertices whose layout stays the same from frame to frame, as
+// in the flat and the height field views of the scenes. The positions
+// of the vertices and the values they show are set up once; every
+// frame only fills in the heights and the colors of the values, in
+// vertices kept between the frames.
+class GridSurface
+{
+public:
+
+    // Vertices at `positions`, row by row with `width` per row, showing
+    // the values at the indices `sources` of the values of a frame.
+    GridSurface(
+        std::vector<glm::vec3> positions,
+        std::vector<size_t> sources,
+        const size_t width,
+        const ev::SurfaceMode mode
+    );
+
+    // Surface data of the values of a frame, the vertices raised by
+    // their value times `height_scale` and colored by `color(value)`,
+    // such as a lookup in a ColorTable.
+    template <typename T, typename Color>
+    ev::SurfaceData surface_data(
+        const T *values, const Color &color, const float height_scale = 0.0f
+    )
+    {
+        for (size_t i = 0; i != this->vertices.size(); ++i)
+        {
+            const float value = static_cast<float>(values[this->sources[i]]);
+            ev::Vertex &vertex = this->vertices[i];
+            vertex.position.z = this->heights[i] + height_scale * value;
+            vertex.color = color(value);
+        }
+        return ev::SurfaceData(this->vertices, this->width, this->mode);
+    }
+
+private:
+
+    std::vector<size_t> sources;
+    size_t width;
+    ev::SurfaceMode mode;
+    // Heights of the positions, the values are added to.
+    std::vector<float> heights;
+    std::vector<ev::Vertex> vertices;
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cmath>
+#include <pml.hpp>
+
+PmlState operator*(float c, const PmlState &pml_state)
+{
+    return PmlState(
+        c * pml_state.wave, c * pml_state.psi_x, c * pml_state.psi_y
+    );
+}
+
+PmlState operator+(const PmlState &pml_state_0, const PmlState &pml_state_1)
+{
+    return PmlState(
+        pml_state_0.wave + pml_state_1.wave,
+        pml_state_0.psi_x + pml_state_1.psi_x,
+        pml_state_0.psi_y + pml_state_1.psi_y
+    );
+}
+
+void shrink_region(PmlState &pml_state, const float tolerance)
+{
+    shrink_region(pml_state.wave, tolerance);
+    pml_state.psi_x.shrink_region(tolerance);
+    pml_state.psi_y.shrink_region(tolerance);
+}
+
+Pml::Pml(
+    const glm::uvec2 size,
+    const WaveParameters &wave_parameters,
+    const PmlParameters &parameters
+)
+    : size(size), wave_parameters(wave_parameters)
+{
+    const float thickness = static_cast<float>(parameters.thickness);
+    const float log_reflection = std::log(1.0f / parameters.reflection);
+    const float sigma_max_x = (parameters.order + 1.0f) * wave_parameters.c *
+                              log_reflection /
+                              (2.0f * thickness * wave_parameters.dx);
+    const float sigma_max_y = (parameters.order + 1.0f) * wave_parameters.c *
+                              log_reflection /
+                              (2.0f * thickness * wave_parameters.dy);
+
+    for (const float shift : {0.0f, 0.5f})
+    {
+        std::vector<float> sigma_x = Pml::profile(
+            size.x,
+            parameters.x_min,
+            parameters.x_max,
+            parameters.thickness,
+            parameters.order,
+            sigma_max_x,
+            shift
+        );
+        std::vector<float> sigma_y = Pml::profile(
+            size.y,
+            parameters.y_min,
+            parameters.y_max,
+            parameters.thickness,
+            parameters.order,
+            sigma_max_y,
+            shift
+        );
+        if (shift == 0.0f)
+        {
+            this->sigma_x = std::move(sigma_x);
+            this->sigma_y = std::move(sigma_y);
+        }
+        else
+        {
+            this->sigma_x_face = std::move(sigma_x);
+            this->sigma_y_face = std::move(sigma_y);
+        }
+    }
+
+    // A cell is affected if the damping of the cell or of one of
+    // its faces is nonzero.
+    for (size_t x = 0; x != size.x; ++x)
+    {
+        if (this->sigma_x[x] > 0.0f || this->sigma_x_face[x] > 0.0f ||
+            (x != 0 && this->sigma_x_face[x - 1] > 0.0f))
+            this->layer_columns.push_back(x);
+    }
+    this->layer_rows.resize(size.y);
+    for (size_t y = 0; y != size.y; ++y)
+    {
+        this->layer_rows[y] = this->sigma_y[y] > 0.0f ||
+                              this->sigma_y_face[y] > 0.0f ||
+                              (y != 0 && this->sigma_y_face[y - 1] > 0.0f);
+    }
+}
+
+void Pml::add_acceleration(
+    const PmlState &state,
+    Field<float> &acc,
+    Field<float> &psi_x_rate,
+    Field<float> &psi_y_rate
+) const
+{
+    const int size_x = this->size.x;
+    const int size_y = this->size.y;
+
+    // Only the cells near the nonzero values can change.
+    Region active = state.wave.amp.get_region()
+                        .unite(state.wave.vel.get_region())
+                        .unite(state.psi_x.get_region())
+                        .unite(state.psi_y.get_region())
+                        .dilate(1);
+    active.min =
+        glm::ivec2(std::max(active.min.x, 0), std::max(active.min.y, 0));
+    active.max = glm::ivec2(
+        std::min(active.max.x, size_x), std::min(active.max.y, size_y)
+    );
+
+    const float c_sq = this->wave_parameters.c * this->wave_parameters.c;
+    const float dx = this->wave_parameters.dx;
+    const float dy = this->wave_parameters.dy;
+    const float *amp = state.wave.amp.data();
+    const float *vel = state.wave.vel.data();
+    const float *psi_x = state.psi_x.data();
+    const float *psi_y = state.psi_y.data();
+
+    Region updated{glm::ivec2(0, 0), glm::ivec2(0, 0)};
+    auto update = [&](const int x, const int y)
+    {
+        const int i = y * size_x + x;
+        const float sigma_x = this->sigma_x[x];
+        const float sigma_y = this->sigma_y[y];
+
+        const float div_psi =
+            (psi_x[i] - ((x != 0) ? psi_x[i - 1] : 0.0f)) / dx +
+            (psi_y[i] - ((y != 0) ? psi_y[i - size_x] : 0.0f)) / dy;
+        acc.data()[i] += div_psi - (sigma_x + sigma_y) * vel[i] -
+                         sigma_x * sigma_y * amp[i];
+
+        if (x != (size_x - 1))
+        {
+            const float sigma_x_face = this->sigma_x_face[x];
+            psi_x_rate.data()[i] =
+                -sigma_x_face * psi_x[i] +
+                c_sq * (sigma_y - sigma_x_face) * (amp[i + 1] - amp[i]) / dx;
+        }
+        if (y != (size_y - 1))
+        {
+            const float sigma_y_face = this->sigma_y_face[y];
+            psi_y_rate.data()[i] = -sigma_y_face * psi_y[i] +
+                                   c_sq * (sigma_x - sigma_y_face) *
+                                       (amp[i + size_x] - amp[i]) / dy;
+        }
+
+        updated = updated.unite(
+            Region{glm::ivec2(x, y), glm::ivec2(x + 1, y + 1)}
+        );
+    };
+
+    for (int y = active.min.y; y < active.max.y; ++y)
+    {
+        if (this->layer_rows[y])
+        {
+            for (int x = active.min.x; x < active.max.x; ++x)
+                update(x, y);
+        }
+        else
+        {
+            for (const int x : this->layer_columns)
+            {
+                if (active.min.x <= x && x < active.max.x)
+                    update(x, y);
+            }
+        }
+    }
+
+    acc.set_region(acc.get_region().unite(updated));
+    psi_x_rate.set_region(updated);
+    psi_y_rate.set_region(updated);
+}
+
+std::vector<float> Pml::profile(
+    const int size,
+    const bool min,
+    const bool max,
+    const int thickness,
+    const float order,
+    const float sigma_max,
+    const float shift
+)
+{
+    std::vector<float> sigma(size, 0.0f);
+    if (thickness <= 0)
+        return sigma;
+
+    for (int i = 0; i != size; ++i)
+    {
+        // Distance of the position from the inner side of the layer.
+        const float p = i + shift;
+        float d = 0.0f;
+        if (min)
+            d = std::max(d, thickness - p);
+        if (max)
+            d = std::max(d, p - (size - 1 - thickness));
+        d = std::min(d / thickness, 1.0f);
+        sigma[i] = sigma_max * std::pow(d, order);
+    }
+    return sigma;
+}
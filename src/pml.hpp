@@ -0,0 +1,119 @@
+#ifndef SIMULATION_VISUALIZATIONS_PML_HPP
+#define SIMULATION_VISUALIZATIONS_PML_HPP
+
+#include <field.hpp>
+#include <vector>
+#include <wave_solver.hpp>
+
+// State of the wave equation with perfectly matched layers; psi_x
+// and psi_y are the auxiliary fields of the layers, stored on the
+// faces between the cells x and x + 1, and y and y + 1.
+struct PmlState
+{
+    PmlState(
+        const FieldState<float> &wave,
+        const Field<float> &psi_x,
+        const Field<float> &psi_y
+    )
+        : wave(wave), psi_x(psi_x), psi_y(psi_y)
+    {}
+
+    FieldState<float> wave;
+    Field<float> psi_x;
+    Field<float> psi_y;
+};
+
+PmlState operator*(float c, const PmlState &pml_state);
+
+PmlState operator+(const PmlState &pml_state_0, const PmlState &pml_state_1);
+
+void shrink_region(PmlState &pml_state, const float tolerance);
+
+struct PmlParameters
+{
+    // Thickness of the layers in cells.
+    int thickness;
+    // Exponent of the polynomial damping profile.
+    float order;
+    // Theoretical reflection coefficient of the layer at normal
+    // incidence, it sets the maximum of the damping.
+    float reflection;
+    bool x_min;
+    bool x_max;
+    bool y_min;
+    bool y_max;
+};
+
+// Perfectly matched layers at the edges of the grid, following the
+// formulation of Grote and Sim,
+//   u_tt + (s_x + s_y) u_t + s_x s_y u = c^2 Lu + div(psi),
+//   psi_x_t = -s_x psi_x + c^2 (s_y - s_x) u_x,
+//   psi_y_t = -s_y psi_y + c^2 (s_x - s_y) u_y,
+// where s_x and s_y are the damping profiles. The layers occupy the
+// outermost cells of the grid; outside of the layers the equation
+// is the undamped wave equation.
+class Pml
+{
+public:
+
+    Pml(const glm::uvec2 size,
+        const WaveParameters &wave_parameters,
+        const PmlParameters &parameters);
+
+    // Adds the terms of the layers to the acceleration, and calculates
+    // the rates of the auxiliary fields into the zero initialized
+    // `psi_x_rate` and `psi_y_rate`.
+    void add_acceleration(
+        const PmlState &state,
+        Field<float> &acc,
+        Field<float> &psi_x_rate,
+        Field<float> &psi_y_rate
+    ) const;
+
+private:
+
+    static std::vector<float> profile(
+        const int size,
+        const bool min,
+        const bool max,
+        const int thickness,
+        const float order,
+        const float sigma_max,
+        const float shift
+    );
+
+    glm::uvec2 size;
+    WaveParameters wave_parameters;
+    // Damping profiles at the cells and at the faces.
+    std::vector<float> sigma_x;
+    std::vector<float> sigma_x_face;
+    std::vector<float> sigma_y;
+    std::vector<float> sigma_y_face;
+    // Columns and rows affected by the layers.
+    std::vector<int> layer_columns;
+    std::vector<bool> layer_rows;
+};
+
+// Iteration of the wave equation with the layers; the policies
+// of the boundaries apply at the outer edges of the layers. The layers
+// should be terminated by Dirichlet boundaries, the outgoing
+// boundaries are unstable at the corners of the layers. The layers
+// damp with first order differences regardless of the stencil `S`.
+template <typename B, typename S = SecondOrder>
+PmlState pml_iteration(
+    const PmlState &state, const WaveParameters &parameters, const Pml &pml
+)
+{
+    Field<float> acc(state.wave.amp.get_size());
+    wave_acceleration<B, S>(state.wave, parameters, acc);
+
+    Field<float> psi_x_rate(state.wave.amp.get_size());
+    Field<float> psi_y_rate(state.wave.amp.get_size());
+    pml.add_acceleration(state, acc, psi_x_rate, psi_y_rate);
+
+    return PmlState(
+        FieldState<float>(state.wave.vel, acc), psi_x_rate, psi_y_rate
+    );
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include <cstdlib>
+#include <fcntl.h>
+#include <process.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+
+pid_t spawn(const std::vector<std::string> &arguments, int *input)
+{
+    if (arguments.empty())
+        return -1;
+
+    // The arguments are prepared before forking, the child only calls
+    // functions which are safe after forking a threaded process.
+    std::vector<char *> argv;
+    for (const auto &argument : arguments)
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    argv.push_back(nullptr);
+
+    // Not inherited by other programs started later. The child reports
+    // a failed start through `status`, which closes with the exec.
+    int pipe_ends[2] = {-1, -1};
+    if (input && pipe2(pipe_ends, O_CLOEXEC) != 0)
+        return -1;
+    int status[2];
+    if (pipe2(status, O_CLOEXEC) != 0)
+    {
+        if (input)
+        {
+            close(pipe_ends[0]);
+            close(pipe_ends[1]);
+        }
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        if (!input || dup2(pipe_ends[0], STDIN_FILENO) >= 0)
+            execvp(argv[0], argv.data());
+        const char failed = 1;
+        (void)!write(status[1], &failed, 1);
+        _exit(127);
+    }
+
+    close(status[1]);
+    char failed;
+    if (pid > 0 && read(status[0], &failed, 1) == 1)
+    {
+        waitpid(pid, nullptr, 0);
+        pid = -1;
+    }
+    close(status[0]);
+
+    if (input)
+    {
+        close(pipe_ends[0]);
+        if (pid < 0)
+            close(pipe_ends[1]);
+        else
+            *input = pipe_ends[1];
+    }
+    return pid;
+}
+
+bool wait_for(const pid_t pid)
+{
+    int status;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+           WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+bool run_program(const std::vector<std::string> &arguments)
+{
+    const pid_t pid = spawn(arguments);
+    return pid > 0 && wait_for(pid);
+}
@@ -0,0 +1,23 @@
+#ifndef SIMULATION_VISUALIZATIONS_PROCESS_HPP
+#define SIMULATION_VISUALIZATIONS_PROCESS_HPP
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Runs programs without a shell: the arguments reach the program as
+// they are, so file names need no quoting. The program `arguments[0]`
+// is searched in the PATH.
+
+// Starts the program; with `input`, its standard input reads from
+// a pipe, whose write end is stored there. Returns the process id,
+// or -1 when the program could not be started.
+pid_t spawn(const std::vector<std::string> &arguments, int *input = nullptr);
+
+// Waits for the process; returns whether it exited successfully.
+bool wait_for(const pid_t pid);
+
+// Runs the program to its end; returns whether it exited successfully.
+bool run_program(const std::vector<std::string> &arguments);
+
+#endif
@@ -0,0 +1,60 @@
+#include <progressive.hpp>
+#include <utility>
+
+ProgressiveFrames::ProgressiveFrames(
+    const int frames, const int reduction, Generator generator
+)
+    : generator(std::move(generator)),
+      preview_frames(frames, ev::SurfaceData(std::vector<ev::Vertex>(), 0)),
+      full_frames(frames, ev::SurfaceData(std::vector<ev::Vertex>(), 0)),
+      finished(new std::atomic<bool>[frames]),
+      stop(false)
+{
+    for (int frame = 0; frame != frames; ++frame)
+        this->finished[frame].store(false, std::memory_order_relaxed);
+
+    this->generator(
+        reduction,
+        [&](const int frame, ev::SurfaceData surface_data)
+        {
+            this->preview_frames[frame] = std::move(surface_data);
+            return true;
+        }
+    );
+
+    this->thread = std::thread(
+        [this]()
+        {
+            this->generator(
+                1,
+                [this](const int frame, ev::SurfaceData surface_data)
+                {
+                    if (this->stop.load(std::memory_order_relaxed))
+                        return false;
+                    this->full_frames[frame] = std::move(surface_data);
+                    this->finished[frame].store(
+                        true, std::memory_order_release
+                    );
+                    return true;
+                }
+            );
+        }
+    );
+}
+
+ProgressiveFrames::~ProgressiveFrames()
+{
+    this->stop.store(true, std::memory_order_relaxed);
+    this->thread.join();
+}
+
+const ev::SurfaceData &ProgressiveFrames::get(const int frame) const
+{
+    return this->is_preview(frame) ? this->preview_frames[frame]
+                                   : this->full_frames[frame];
+}
+
+bool ProgressiveFrames::is_preview(const int frame) const
+{
+    return !this->finished[frame].load(std::memory_order_acquire);
+}
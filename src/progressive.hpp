@@ -0,0 +1,58 @@
+#ifndef SIMULATION_VISUALIZATIONS_PROGRESSIVE_HPP
+#define SIMULATION_VISUALIZATIONS_PROGRESSIVE_HPP
+
+#include <atomic>
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ev = elementary_visualizer;
+
+// Frames of a scene simulated twice: first on a grid reduced by
+// a factor, so a preview of all of the frames is available quickly,
+// and then on the full grid in a background thread, which replaces
+// the preview frames as they are finished.
+class ProgressiveFrames
+{
+public:
+
+    // Receives the frames in order; returns false when the simulation
+    // should stop early.
+    using Emit = std::function<bool(const int, ev::SurfaceData)>;
+
+    // Simulates the scene on the grid reduced by `reduction`, 1 being
+    // the full grid.
+    using Generator = std::function<void(const int, const Emit &)>;
+
+    // Generates the preview before returning, and starts the full
+    // simulation.
+    ProgressiveFrames(
+        const int frames, const int reduction, Generator generator
+    );
+
+    // Stops the full simulation at its next frame.
+    ~ProgressiveFrames();
+
+    ProgressiveFrames(const ProgressiveFrames &) = delete;
+    ProgressiveFrames &operator=(const ProgressiveFrames &) = delete;
+
+    // The frame at full resolution if it is finished, otherwise
+    // the preview.
+    const ev::SurfaceData &get(const int frame) const;
+
+    bool is_preview(const int frame) const;
+
+private:
+
+    Generator generator;
+    std::vector<ev::SurfaceData> preview_frames;
+    std::vector<ev::SurfaceData> full_frames;
+    // Set by the background thread after storing the full frame.
+    std::unique_ptr<std::atomic<bool>[]> finished;
+    std::atomic<bool> stop;
+    std::thread thread;
+};
+
+#endif
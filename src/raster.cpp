@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cmath>
+#include <process.hpp>
+#include <raster.hpp>
+#include <unistd.h>
+#include <workers.hpp>
+
+namespace
+{
+
+std::uint8_t to_byte(const float value)
+{
+    return static_cast<std::uint8_t>(
+        std::clamp(std::lround(value), 0l, 255l)
+    );
+}
+
+}
+
+YuvFrame::YuvFrame(const glm::uvec2 size)
+    : size(size),
+      y(size.x * size.y),
+      u((size.x / 2) * (size.y / 2)),
+      v((size.x / 2) * (size.y / 2))
+{}
+
+ColorTable::ColorTable(
+    const std::vector<std::pair<float, glm::vec4>> &colormap,
+    const int entries
+)
+    : rgba(entries),
+      y(entries),
+      u(entries),
+      v(entries),
+      min(colormap.front().first),
+      scale((entries - 1) / (colormap.back().first - colormap.front().first)),
+      last(entries - 1)
+{
+    for (int i = 0; i != entries; ++i)
+    {
+        // to_color leaves out the value of the last color.
+        const float value = this->min + i / this->scale;
+        const glm::vec4 color = (i == this->last) ? colormap.back().second
+                                                  : to_color(value, colormap);
+        this->rgba[i] = color;
+        const float r = color.r;
+        const float g = color.g;
+        const float b = color.b;
+        this->y[i] = to_byte(16.0f + 219.0f * (0.299f * r + 0.587f * g +
+                                               0.114f * b));
+        this->u[i] = to_byte(128.0f + 224.0f * (-0.168736f * r -
+                                                0.331264f * g + 0.5f * b));
+        this->v[i] = to_byte(128.0f + 224.0f * (0.5f * r - 0.418688f * g -
+                                                0.081312f * b));
+    }
+}
+
+void rasterize(
+    const Field<float> &field,
+    const ColorTable &colors,
+    YuvFrame &frame,
+    const float view_extent
+)
+{
+    const glm::uvec2 size = frame.size;
+    const glm::uvec2 field_size = field.get_size();
+
+    // Cell left of every column of pixels, and the weight of the cell
+    // right of it.
+    std::vector<int> cells(size.x);
+    std::vector<float> weights(size.x);
+    for (size_t x = 0; x != size.x; ++x)
+    {
+        // Position in the copy of the field, from 0 to 1.
+        const float view_x = view_extent * (2.0f * (x + 0.5f) / size.x - 1);
+        const float tile_x = (view_x + 1.0f) / 2;
+        const float fx = (tile_x - std::floor(tile_x)) * (field_size.x - 1);
+        cells[x] = std::min<int>(fx, field_size.x - 2);
+        weights[x] = fx - cells[x];
+    }
+
+    Workers::get().run(
+        size.y / 2,
+        4 * size.x,
+        [&](const size_t begin, const size_t end)
+        {
+            std::vector<int> row_indices[2] = {
+                std::vector<int>(size.x), std::vector<int>(size.x)
+            };
+            for (size_t pair = begin; pair != end; ++pair)
+            {
+                for (const int i : {0, 1})
+                {
+                    // The first row of the frame is at the top.
+                    const size_t y = 2 * pair + i;
+                    const float fy =
+                        (size.y - y - 0.5f) / size.y * (field_size.y - 1);
+                    const int cell_y = std::min<int>(fy, field_size.y - 2);
+                    const float wy = fy - cell_y;
+                    const float *row_0 =
+                        field.data() + cell_y * field_size.x;
+                    const float *row_1 = row_0 + field_size.x;
+                    std::uint8_t *luma = frame.y.data() + y * size.x;
+                    int *indices = row_indices[i].data();
+                    for (size_t x = 0; x != size.x; ++x)
+                    {
+                        const int c = cells[x];
+                        const float wx = weights[x];
+                        const float bottom = row_0[c] + wx * (row_0[c + 1] -
+                                                              row_0[c]);
+                        const float top = row_1[c] + wx * (row_1[c + 1] -
+                                                           row_1[c]);
+                        const float value = bottom + wy * (top - bottom);
+                        indices[x] = colors.index(value);
+                        luma[x] = colors.y[indices[x]];
+                    }
+                }
+
+                // Chroma of the blocks of two by two pixels.
+                std::uint8_t *u = frame.u.data() + pair * (size.x / 2);
+                std::uint8_t *v = frame.v.data() + pair * (size.x / 2);
+                const int *indices_0 = row_indices[0].data();
+                const int *indices_1 = row_indices[1].data();
+                for (size_t x = 0; x != size.x / 2; ++x)
+                {
+                    const int a = indices_0[2 * x];
+                    const int b = indices_0[2 * x + 1];
+                    const int c = indices_1[2 * x];
+                    const int d = indices_1[2 * x + 1];
+                    u[x] = (colors.u[a] + colors.u[b] + colors.u[c] +
+                            colors.u[d] + 2) /
+                           4;
+                    v[x] = (colors.v[a] + colors.v[b] + colors.v[c] +
+                            colors.v[d] + 2) /
+                           4;
+                }
+            }
+        }
+    );
+}
+
+ev::Expected<std::shared_ptr<Y4mWriter>, ev::Error> Y4mWriter::create(
+    const std::string &file_name,
+    const glm::uvec2 size,
+    const int frame_rate
+)
+{
+    // The chroma planes need even sizes.
+    if (size.x % 2 != 0 || size.y % 2 != 0)
+        return ev::Unexpected<ev::Error>(ev::Error());
+
+    std::FILE *stream = std::fopen(file_name.c_str(), "wb");
+    if (!stream)
+        return ev::Unexpected<ev::Error>(ev::Error());
+    return std::shared_ptr<Y4mWriter>(
+        new Y4mWriter(stream, -1, size, frame_rate)
+    );
+}
+
+ev::Expected<std::shared_ptr<Y4mWriter>, ev::Error> Y4mWriter::create(
+    const std::vector<std::string> &encoder,
+    const glm::uvec2 size,
+    const int frame_rate
+)
+{
+    if (size.x % 2 != 0 || size.y % 2 != 0)
+        return ev::Unexpected<ev::Error>(ev::Error());
+
+    int input;
+    const pid_t pid = spawn(encoder, &input);
+    if (pid < 0)
+        return ev::Unexpected<ev::Error>(ev::Error());
+    std::FILE *stream = fdopen(input, "wb");
+    if (!stream)
+    {
+        close(input);
+        wait_for(pid);
+        return ev::Unexpected<ev::Error>(ev::Error());
+    }
+    return std::shared_ptr<Y4mWriter>(
+        new Y4mWriter(stream, pid, size, frame_rate)
+    );
+}
+
+Y4mWriter::Y4mWriter(
+    std::FILE *stream, pid_t encoder, glm::uvec2 size, int frame_rate
+)
+    : stream(stream),
+      encoder(encoder),
+      size(size)
+{
+    std::fprintf(
+        stream,
+        "YUV4MPEG2 W%u H%u F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+        size.x,
+        size.y,
+        frame_rate
+    );
+}
+
+Y4mWriter::~Y4mWriter()
+{
+    std::fclose(this->stream);
+    if (this->encoder > 0)
+        wait_for(this->encoder);
+}
+
+bool Y4mWriter::write(const YuvFrame &frame)
+{
+    if (frame.size != this->size)
+        return false;
+    std::fputs("FRAME\n", this->stream);
+    for (const auto *plane : {&frame.y, &frame.u, &frame.v})
+    {
+        if (std::fwrite(plane->data(), 1, plane->size(), this->stream) !=
+            plane->size())
+        {
+            return false;
+        }
+    }
+    return true;
+}
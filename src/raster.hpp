@@ -0,0 +1,118 @@
+#ifndef SIMULATION_VISUALIZATIONS_RASTER_HPP
+#define SIMULATION_VISUALIZATIONS_RASTER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <field.hpp>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace ev = elementary_visualizer;
+
+// Frame with 4:2:0 chroma subsampling, in the limited range of
+// BT.601; the chroma samples lie between their four luma samples.
+struct YuvFrame
+{
+    explicit YuvFrame(const glm::uvec2 size);
+
+    glm::uvec2 size;
+    std::vector<std::uint8_t> y;
+    std::vector<std::uint8_t> u;
+    std::vector<std::uint8_t> v;
+};
+
+// Colormap of to_color sampled at evenly spaced values, in RGBA and in
+// YUV; values outside of the colormap take the colors of its ends.
+class ColorTable
+{
+public:
+
+    explicit ColorTable(
+        const std::vector<std::pair<float, glm::vec4>> &colormap,
+        const int entries = 1024
+    );
+
+    int index(const float value) const
+    {
+        const float i = (value - this->min) * this->scale + 0.5f;
+        return i <= 0.0f       ? 0
+               : i >= this->last ? this->last
+                                 : static_cast<int>(i);
+    }
+
+    // Color of the value, without the search of to_color.
+    glm::vec4 color(const float value) const
+    {
+        return this->rgba[this->index(value)];
+    }
+
+    std::vector<glm::vec4> rgba;
+    std::vector<std::uint8_t> y;
+    std::vector<std::uint8_t> u;
+    std::vector<std::uint8_t> v;
+
+private:
+
+    float min;
+    float scale;
+    int last;
+};
+
+// Renders the field like the flat grids of the scenes seen
+// orthographically: the field spans [-1, +1] along both axes, the first
+// row at the bottom, and the frame shows [-view_extent, +view_extent]
+// along x, the field repeated periodically beyond its edges, like
+// tile_grid. The values are interpolated bilinearly between the cells
+// and then colored, without the graphics pipeline; the pairs of rows
+// of the frame are split between the workers.
+void rasterize(
+    const Field<float> &field,
+    const ColorTable &colors,
+    YuvFrame &frame,
+    const float view_extent = 1.0f
+);
+
+// Writes frames as a YUV4MPEG2 stream, which encoders such as ffmpeg
+// read, to a file, or to the standard input of an encoder.
+class Y4mWriter
+{
+public:
+
+    static ev::Expected<std::shared_ptr<Y4mWriter>, ev::Error> create(
+        const std::string &file_name,
+        const glm::uvec2 size,
+        const int frame_rate
+    );
+
+    // Starts the encoder with the arguments, without a shell, see
+    // spawn.
+    static ev::Expected<std::shared_ptr<Y4mWriter>, ev::Error> create(
+        const std::vector<std::string> &encoder,
+        const glm::uvec2 size,
+        const int frame_rate
+    );
+
+    // Waits for the encoder to finish.
+    ~Y4mWriter();
+
+    Y4mWriter(const Y4mWriter &) = delete;
+    Y4mWriter &operator=(const Y4mWriter &) = delete;
+
+    bool write(const YuvFrame &frame);
+
+private:
+
+    Y4mWriter(
+        std::FILE *stream, pid_t encoder, glm::uvec2 size, int frame_rate
+    );
+
+    std::FILE *stream;
+    // Process of the encoder, -1 for a file.
+    pid_t encoder;
+    glm::uvec2 size;
+};
+
+#endif
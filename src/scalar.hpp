@@ -0,0 +1,127 @@
+#ifndef SIMULATION_VISUALIZATIONS_SCALAR_HPP
+#define SIMULATION_VISUALIZATIONS_SCALAR_HPP
+
+#include <bit>
+#include <cstdint>
+
+// IEEE 754 half precision storage type; the values are converted
+// to float for any arithmetic, rounding to nearest even on the way
+// back.
+class Half
+{
+public:
+
+    Half() = default;
+
+    Half(const float value) : bits(Half::from_float(value)) {}
+
+    operator float() const
+    {
+        return Half::to_float(this->bits);
+    }
+
+private:
+
+    static std::uint16_t from_float(const float value)
+    {
+        const std::uint32_t f = std::bit_cast<std::uint32_t>(value);
+        const std::uint32_t sign = (f >> 16) & 0x8000u;
+        std::uint32_t magnitude = f & 0x7fffffffu;
+
+        // Infinity and NaN.
+        if (magnitude >= 0x7f800000u)
+        {
+            return sign | 0x7c00u |
+                   ((magnitude > 0x7f800000u) ? 0x0200u : 0x0000u);
+        }
+        // Overflow to infinity.
+        if (magnitude >= 0x477ff000u)
+            return sign | 0x7c00u;
+        // Subnormal; adding 0.5 aligns the mantissa of the result
+        // with the subnormal half mantissa, the addition rounds.
+        if (magnitude < 0x38800000u)
+        {
+            const float shifted = std::bit_cast<float>(magnitude) + 0.5f;
+            return sign | (std::bit_cast<std::uint32_t>(shifted) - 0x3f000000u);
+        }
+        // Normal; rebias the exponent and round to nearest even.
+        const std::uint32_t odd = (magnitude >> 13) & 1u;
+        magnitude += 0xc8000fffu + odd;
+        return sign | (magnitude >> 13);
+    }
+
+    static float to_float(const std::uint16_t bits)
+    {
+        const std::uint32_t sign = static_cast<std::uint32_t>(bits & 0x8000u)
+                                   << 16;
+        const std::uint32_t exponent = (bits >> 10) & 0x1fu;
+        const std::uint32_t mantissa = bits & 0x03ffu;
+
+        if (exponent == 0x1fu)
+        {
+            return std::bit_cast<float>(sign | 0x7f800000u | (mantissa << 13));
+        }
+        if (exponent == 0)
+        {
+            // Subnormal, mantissa * 2^-24.
+            const float value = static_cast<float>(mantissa) * 0x1.0p-24f;
+            return sign ? -value : value;
+        }
+        return std::bit_cast<float>(
+            sign | ((exponent + 112u) << 23) | (mantissa << 13)
+        );
+    }
+
+    std::uint16_t bits;
+};
+
+// Brain floating point storage type, the upper half of a float;
+// it keeps the range of float with a 8 bit mantissa.
+class BFloat16
+{
+public:
+
+    BFloat16() = default;
+
+    BFloat16(const float value) : bits(BFloat16::from_float(value)) {}
+
+    operator float() const
+    {
+        return std::bit_cast<float>(static_cast<std::uint32_t>(this->bits)
+                                    << 16);
+    }
+
+private:
+
+    static std::uint16_t from_float(const float value)
+    {
+        const std::uint32_t f = std::bit_cast<std::uint32_t>(value);
+        // Quiet NaN.
+        if ((f & 0x7fffffffu) > 0x7f800000u)
+            return ((f >> 16) & 0x8000u) | 0x7fc0u;
+        // Round to nearest even.
+        const std::uint32_t odd = (f >> 16) & 1u;
+        return (f + 0x7fffu + odd) >> 16;
+    }
+
+    std::uint16_t bits;
+};
+
+// Type in which the arithmetic on values stored as T is carried out;
+// the narrow storage types are widened to float.
+template <typename T>
+struct Accumulation
+{
+    using type = float;
+};
+
+template <>
+struct Accumulation<double>
+{
+    using type = double;
+};
+
+template <typename T>
+using accumulation_t = typename Accumulation<T>::type;
+
+#endif
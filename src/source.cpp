@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cmath>
+#include <source.hpp>
+
+SourceStamp SourceStamp::create(
+    const glm::uvec2 grid_size,
+    std::function<float(const int, const int)> profile,
+    const float threshold
+)
+{
+    Field<float> values(grid_size);
+    float max_value = 0.0f;
+    for (size_t y = 0; y != grid_size.y; ++y)
+    {
+        for (size_t x = 0; x != grid_size.x; ++x)
+        {
+            values(x, y) = profile(x, y);
+            max_value = std::max(max_value, std::fabs(values(x, y)));
+        }
+    }
+
+    glm::ivec2 min(grid_size.x, grid_size.y);
+    glm::ivec2 max(-1, -1);
+    for (size_t y = 0; y != grid_size.y; ++y)
+    {
+        for (size_t x = 0; x != grid_size.x; ++x)
+        {
+            if (std::fabs(values(x, y)) > threshold * max_value)
+            {
+                min = glm::ivec2(
+                    std::min<int>(min.x, x), std::min<int>(min.y, y)
+                );
+                max = glm::ivec2(
+                    std::max<int>(max.x, x), std::max<int>(max.y, y)
+                );
+            }
+        }
+    }
+
+    SourceStamp stamp{glm::ivec2(0, 0), glm::uvec2(0, 0), std::vector<float>()};
+    if (max.x < min.x)
+        return stamp;
+
+    stamp.origin = min;
+    stamp.size = glm::uvec2(max.x - min.x + 1, max.y - min.y + 1);
+    stamp.weights.resize(stamp.size.x * stamp.size.y);
+    for (size_t y = 0; y != stamp.size.y; ++y)
+    {
+        for (size_t x = 0; x != stamp.size.x; ++x)
+        {
+            stamp.weights[y * stamp.size.x + x] =
+                values(min.x + x, min.y + y);
+        }
+    }
+
+    return stamp;
+}
+
+void add_sources(
+    Field<float> &acc, const std::vector<Source> &sources, const float t
+)
+{
+    const size_t size_x = acc.get_size().x;
+    for (const Source &source : sources)
+    {
+        if (t < source.t_begin || t > source.t_end)
+            continue;
+
+        const float envelope = source.envelope(t);
+        if (envelope == 0.0f)
+            continue;
+
+        const SourceStamp &stamp = source.stamp;
+        acc.set_region(acc.get_region().unite(Region{
+            stamp.origin, stamp.origin + glm::ivec2(stamp.size)
+        }));
+        for (size_t y = 0; y != stamp.size.y; ++y)
+        {
+            float *acc_row =
+                acc.data() + (stamp.origin.y + y) * size_x + stamp.origin.x;
+            const float *weights = stamp.weights.data() + y * stamp.size.x;
+            for (size_t x = 0; x != stamp.size.x; ++x)
+                acc_row[x] += envelope * weights[x];
+        }
+    }
+}
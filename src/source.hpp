@@ -0,0 +1,43 @@
+#ifndef SIMULATION_VISUALIZATIONS_SOURCE_HPP
+#define SIMULATION_VISUALIZATIONS_SOURCE_HPP
+
+#include <field.hpp>
+#include <functional>
+#include <vector>
+
+// Spatial profile of a source. Only the weights inside of the bounding
+// box of the non-negligible cells are stored.
+struct SourceStamp
+{
+    // Evaluates the profile once for every cell of the grid, and keeps
+    // the cells where the magnitude is larger than `threshold` times
+    // the maximum magnitude.
+    static SourceStamp create(
+        const glm::uvec2 grid_size,
+        std::function<float(const int, const int)> profile,
+        const float threshold = 1e-6f
+    );
+
+    glm::ivec2 origin;
+    glm::uvec2 size;
+    std::vector<float> weights;
+};
+
+// Source term of the wave equation, the product of the spatial
+// profile and the temporal envelope. Outside of the
+// [t_begin, t_end] window the source is zero.
+struct Source
+{
+    SourceStamp stamp;
+    std::function<float(const float)> envelope;
+    float t_begin;
+    float t_end;
+};
+
+// Adds the sources at time `t` to the acceleration; the envelope
+// of every active source is evaluated only once.
+void add_sources(
+    Field<float> &acc, const std::vector<Source> &sources, const float t
+);
+
+#endif
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <spectral_solver.hpp>
+
+SpectralSolver::SpectralSolver(
+    const FieldState<float> &initial,
+    const WaveParameters &parameters,
+    const Symbol symbol
+)
+    : size(initial.amp.get_size()),
+      fft_x(size.x),
+      fft_y(size.y),
+      amp_hat(size.x * size.y),
+      vel_hat(size.x * size.y),
+      omega(size.x * size.y)
+{
+    const float *amp = initial.amp.data();
+    const float *vel = initial.vel.data();
+    for (size_t i = 0; i != this->amp_hat.size(); ++i)
+    {
+        this->amp_hat[i] = amp[i];
+        this->vel_hat[i] = vel[i];
+    }
+    fft_2d(this->amp_hat.data(), this->fft_x, this->fft_y, false);
+    fft_2d(this->vel_hat.data(), this->fft_x, this->fft_y, false);
+
+    // Mode (x, y) advances the phase by 2 pi x / n_x and 2 pi y / n_y
+    // per cell; its frequency follows from the eigenvalue of
+    // the stencil.
+    const double c = parameters.c;
+    for (size_t y = 0; y != this->size.y; ++y)
+    {
+        const double theta_y = 2.0 * std::numbers::pi * y / this->size.y;
+        for (size_t x = 0; x != this->size.x; ++x)
+        {
+            const double theta_x = 2.0 * std::numbers::pi * x / this->size.x;
+            const double eigenvalue =
+                symbol(theta_x, theta_y, parameters.dx, parameters.dy);
+            this->omega[y * this->size.x + x] =
+                c * std::sqrt(std::max(-eigenvalue, 0.0));
+        }
+    }
+}
+
+Field<float> SpectralSolver::amplitude(const float t) const
+{
+    return this->evaluate(t, false);
+}
+
+FieldState<float> SpectralSolver::state(const float t) const
+{
+    return FieldState<float>(this->evaluate(t, false), this->evaluate(t, true));
+}
+
+Field<float> SpectralSolver::evaluate(const float t, const bool velocity) const
+{
+    std::vector<std::complex<double>> spectrum(this->amp_hat.size());
+    for (size_t i = 0; i != spectrum.size(); ++i)
+    {
+        const double omega = this->omega[i];
+        const double cos_t = std::cos(omega * t);
+        const double sin_t = std::sin(omega * t);
+        if (velocity)
+        {
+            spectrum[i] =
+                -omega * sin_t * this->amp_hat[i] + cos_t * this->vel_hat[i];
+        }
+        else
+        {
+            // The zero mode drifts with constant velocity.
+            const double sin_t_over_omega = (omega != 0.0) ? sin_t / omega : t;
+            spectrum[i] =
+                cos_t * this->amp_hat[i] + sin_t_over_omega * this->vel_hat[i];
+        }
+    }
+    fft_2d(spectrum.data(), this->fft_x, this->fft_y, true);
+
+    Field<float> field(this->size);
+    float *data = field.data();
+    const double normalization = 1.0 / spectrum.size();
+    for (size_t i = 0; i != spectrum.size(); ++i)
+        data[i] = static_cast<float>(spectrum[i].real() * normalization);
+    return field;
+}
@@ -0,0 +1,49 @@
+#ifndef SIMULATION_VISUALIZATIONS_SPECTRAL_SOLVER_HPP
+#define SIMULATION_VISUALIZATIONS_SPECTRAL_SOLVER_HPP
+
+#include <complex>
+#include <fft.hpp>
+#include <field.hpp>
+#include <vector>
+#include <wave_solver.hpp>
+
+// Solver of the wave equation on fully periodic grids with constant
+// wave speed. The Laplacian is diagonal in Fourier space, so the
+// initial state is transformed once, and every mode is advanced
+// analytically; the state at any time is evaluated directly with
+// inverse transforms, without time stepping.
+//
+// The modes oscillate with the frequencies of the Laplacian stencil
+// given by `symbol`, so the result is the exact time evolution of
+// the same spatial discretization as of the finite difference solver.
+class SpectralSolver
+{
+public:
+
+    using Symbol = double (*)(double, double, double, double);
+
+    SpectralSolver(
+        const FieldState<float> &initial,
+        const WaveParameters &parameters,
+        const Symbol symbol = &laplacian_symbol<SecondOrder>
+    );
+
+    Field<float> amplitude(const float t) const;
+
+    FieldState<float> state(const float t) const;
+
+private:
+
+    // Inverse transform of the spectrum with the amplitude (or the
+    // velocity) of every mode at time `t`.
+    Field<float> evaluate(const float t, const bool velocity) const;
+
+    glm::uvec2 size;
+    Fft fft_x;
+    Fft fft_y;
+    std::vector<std::complex<double>> amp_hat;
+    std::vector<std::complex<double>> vel_hat;
+    std::vector<double> omega;
+};
+
+#endif
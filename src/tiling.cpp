@@ -0,0 +1,48 @@
+#include <cmath>
+#include <tiling.hpp>
+#include <utility>
+
+GridSurface tile_grid(
+    const std::vector<glm::vec3> &tile,
+    const size_t width,
+    const float x_min,
+    const float x_max,
+    const ev::SurfaceMode mode
+)
+{
+    const size_t height = tile.size() / width;
+
+    // Columns of the copies from left to right, as the column of the
+    // tile and its offset; the copy k spans [2k - 1, 2k + 1].
+    std::vector<std::pair<size_t, float>> columns;
+    const int first_copy = static_cast<int>(std::floor((x_min + 1.0f) / 2));
+    const int last_copy = static_cast<int>(std::ceil((x_max - 1.0f) / 2));
+    for (int copy = first_copy; copy <= last_copy; ++copy)
+    {
+        const float offset = 2.0f * copy;
+        for (size_t x = 0; x != width; ++x)
+        {
+            if (x + 1 != width && tile[x + 1].x + offset <= x_min)
+                continue;
+            if (x != 0 && tile[x - 1].x + offset >= x_max)
+                break;
+            columns.emplace_back(x, offset);
+        }
+    }
+
+    std::vector<glm::vec3> positions(columns.size() * height);
+    std::vector<size_t> sources(positions.size());
+    for (size_t y = 0; y != height; ++y)
+    {
+        for (size_t i = 0; i != columns.size(); ++i)
+        {
+            const size_t source = y * width + columns[i].first;
+            positions[y * columns.size() + i] =
+                tile[source] + glm::vec3(columns[i].second, 0.0f, 0.0f);
+            sources[y * columns.size() + i] = source;
+        }
+    }
+    return GridSurface(
+        std::move(positions), std::move(sources), columns.size(), mode
+    );
+}
@@ -0,0 +1,25 @@
+#ifndef SIMULATION_VISUALIZATIONS_TILING_HPP
+#define SIMULATION_VISUALIZATIONS_TILING_HPP
+
+#include <elementary_visualizer/elementary_visualizer.hpp>
+#include <grid_surface.hpp>
+#include <vector>
+
+namespace ev = elementary_visualizer;
+
+// Grid of a periodic tile of vertices, given row by row with `width`
+// positions per row and spanning [-1, +1] along x, repeated every 2
+// along x as far as it is seen within [x_min, x_max]; the vertices of
+// all of the copies show the values of the tile. A single surface
+// shows all of the copies, so their vertices are uploaded once per
+// frame instead of once per copy, and only the columns seen, with one
+// more at either end for the cells cut by the edges.
+GridSurface tile_grid(
+    const std::vector<glm::vec3> &tile,
+    const size_t width,
+    const float x_min,
+    const float x_max,
+    const ev::SurfaceMode mode
+);
+
+#endif
@@ -0,0 +1,495 @@
+#ifndef SIMULATION_VISUALIZATIONS_WAVE_SOLVER_HPP
+#define SIMULATION_VISUALIZATIONS_WAVE_SOLVER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <field.hpp>
+#include <type_traits>
+
+// Cells of a grid line orthogonal to an edge; the cell with index 0
+// is the edge cell, and the indices increase into the grid.
+template <typename T>
+struct EdgeLine
+{
+    accumulation_t<T> amp(const int k) const
+    {
+        return this->amp_data[k * this->stride];
+    }
+
+    accumulation_t<T> vel(const int k) const
+    {
+        return this->vel_data[k * this->stride];
+    }
+
+    const T *amp_data;
+    const T *vel_data;
+    std::ptrdiff_t stride;
+    int size;
+    // Grid spacing divided by the wave speed.
+    float h_over_c;
+};
+
+// Boundary condition policies. Each of them gives the value of
+// the ghost cell `depth` cells outside of the grid, beyond the edge
+// cell of the line, in the accumulation type of the line.
+
+struct Periodic
+{
+    template <typename Line>
+    static auto ghost(const Line &line, const int depth)
+    {
+        return line.amp(line.size - depth);
+    }
+};
+
+// The ghost cells are zero.
+struct Dirichlet
+{
+    template <typename Line>
+    static auto ghost(const Line &line, const int)
+    {
+        return decltype(line.amp(0))(0);
+    }
+};
+
+struct Neumann
+{
+    template <typename Line>
+    static auto ghost(const Line &line, const int depth)
+    {
+        return line.amp(depth - 1);
+    }
+};
+
+// First order approximation of only outgoing waves.
+struct Outgoing
+{
+    template <typename Line>
+    static auto ghost(const Line &line, const int depth)
+    {
+        return line.amp(depth) - 2.0f * depth * line.h_over_c * line.vel(0);
+    }
+};
+
+// Mirror symmetry about the edge cell, see Symmetry.
+struct Mirror
+{
+    template <typename Line>
+    static auto ghost(const Line &line, const int depth)
+    {
+        return line.amp(depth);
+    }
+};
+
+template <typename XMin, typename XMax, typename YMin, typename YMax>
+struct Boundaries
+{
+    using x_min = XMin;
+    using x_max = XMax;
+    using y_min = YMin;
+    using y_max = YMax;
+};
+
+struct WaveParameters
+{
+    float c;
+    float dx;
+    float dy;
+};
+
+// Coefficients of the Laplacian multiplied by the square
+// of the wave speed, in the accumulation type A.
+template <typename A>
+struct LaplacianScales
+{
+    constexpr LaplacianScales(const WaveParameters &parameters)
+        : x(A(parameters.c) * A(parameters.c) /
+            (A(parameters.dx) * A(parameters.dx))),
+          y(A(parameters.c) * A(parameters.c) /
+            (A(parameters.dy) * A(parameters.dy))),
+          diagonal(
+              A(parameters.c) * A(parameters.c) /
+              (A(parameters.dx) * A(parameters.dx) +
+               A(parameters.dy) * A(parameters.dy))
+          )
+    {}
+
+    A x;
+    A y;
+    A diagonal;
+};
+
+// Laplacian stencils. The axis aligned stencils apply the same
+// central second derivative along both axes; `weights[j]` is the
+// coefficient of the cells `j` cells away.
+
+// Five point stencil.
+struct SecondOrder
+{
+    static constexpr int radius = 1;
+    static constexpr bool isotropic = false;
+    static constexpr std::array<double, 2> weights = {-2.0, 1.0};
+};
+
+// Nine point wide stencil.
+struct FourthOrder
+{
+    static constexpr int radius = 2;
+    static constexpr bool isotropic = false;
+    static constexpr std::array<double, 3> weights = {
+        -5.0 / 2.0, 4.0 / 3.0, -1.0 / 12.0
+    };
+};
+
+// Thirteen point wide stencil.
+struct SixthOrder
+{
+    static constexpr int radius = 3;
+    static constexpr bool isotropic = false;
+    static constexpr std::array<double, 4> weights = {
+        -49.0 / 18.0, 3.0 / 2.0, -3.0 / 20.0, 1.0 / 90.0
+    };
+};
+
+// Compact nine point stencil with the diagonal neighbours; its leading
+// error term is rotationally symmetric, so the waves spread with
+// the same speed in every direction. Isotropic only for square cells.
+struct Isotropic
+{
+    static constexpr int radius = 1;
+    static constexpr bool isotropic = true;
+};
+
+// Evaluates the stencil; `amp(i, j)` is the amplitude at the
+// offset (i, j) from the cell.
+template <typename S, typename A, typename Sample>
+constexpr A laplacian(const Sample &amp, const LaplacianScales<A> &scales)
+{
+    if constexpr (S::isotropic)
+    {
+        const A center = amp(0, 0);
+        const A axis = scales.x * (amp(-1, 0) + amp(1, 0) - A(2) * center) +
+                       scales.y * (amp(0, -1) + amp(0, 1) - A(2) * center);
+        const A diagonal = scales.diagonal * (amp(-1, -1) + amp(1, -1) +
+                                              amp(-1, 1) + amp(1, 1) -
+                                              A(4) * center);
+        return A(2.0 / 3.0) * axis + A(1.0 / 3.0) * diagonal;
+    }
+    else
+    {
+        A result = A(S::weights[0]) * (scales.x + scales.y) * amp(0, 0);
+        for (int j = 1; j <= S::radius; ++j)
+        {
+            result += A(S::weights[j]) * (scales.x * (amp(-j, 0) + amp(j, 0)) +
+                                          scales.y * (amp(0, -j) + amp(0, j)));
+        }
+        return result;
+    }
+}
+
+// Whether the stencil gives the Laplacian of x^2 + y^2, which is 4,
+// up to rounding; every stencil is exact for quadratics.
+template <typename S>
+constexpr bool exact_for_quadratics()
+{
+    const double result = laplacian<S>(
+        [](const int i, const int j) { return double(i * i + j * j); },
+        LaplacianScales<double>(WaveParameters{1.0f, 1.0f, 1.0f})
+    );
+    return result > 4.0 - 1e-12 && result < 4.0 + 1e-12;
+}
+
+static_assert(exact_for_quadratics<SecondOrder>());
+static_assert(exact_for_quadratics<FourthOrder>());
+static_assert(exact_for_quadratics<SixthOrder>());
+static_assert(exact_for_quadratics<Isotropic>());
+
+// Eigenvalue of the stencil, without the square of the wave speed, for
+// the Fourier mode with the phase increments `theta_x` and `theta_y`
+// per cell.
+template <typename S>
+double laplacian_symbol(
+    const double theta_x, const double theta_y, const double dx, const double dy
+)
+{
+    if constexpr (S::isotropic)
+    {
+        const double axis = (2.0 * std::cos(theta_x) - 2.0) / (dx * dx) +
+                            (2.0 * std::cos(theta_y) - 2.0) / (dy * dy);
+        const double diagonal =
+            (4.0 * std::cos(theta_x) * std::cos(theta_y) - 4.0) /
+            (dx * dx + dy * dy);
+        return (2.0 / 3.0) * axis + (1.0 / 3.0) * diagonal;
+    }
+    else
+    {
+        double symbol_x = S::weights[0];
+        double symbol_y = S::weights[0];
+        for (int j = 1; j <= S::radius; ++j)
+        {
+            symbol_x += 2.0 * S::weights[j] * std::cos(j * theta_x);
+            symbol_y += 2.0 * S::weights[j] * std::cos(j * theta_y);
+        }
+        return symbol_x / (dx * dx) + symbol_y / (dy * dy);
+    }
+}
+
+template <typename B, typename T>
+accumulation_t<T> boundary_sample(
+    const FieldState<T> &state,
+    const WaveParameters &parameters,
+    const int x,
+    const int y
+);
+
+// Line of ghost cells along the x axis in the ghost row `y`, which is
+// outside of the grid; the ghost cells of the corners are given by
+// the x boundary policy applied to the ghost row.
+template <typename B, typename T>
+struct GhostRow
+{
+    accumulation_t<T> amp(const int k) const
+    {
+        return boundary_sample<B>(
+            *this->state, *this->parameters, this->edge + k * this->stride, y
+        );
+    }
+
+    accumulation_t<T> vel(const int k) const
+    {
+        const int size_y = this->state->vel.get_size().y;
+        const int row = std::clamp(this->y, 0, size_y - 1);
+        return this->state->vel(this->edge + k * this->stride, row);
+    }
+
+    const FieldState<T> *state;
+    const WaveParameters *parameters;
+    int edge;
+    int stride;
+    int y;
+    int size;
+    float h_over_c;
+};
+
+// Amplitude at (x, y), which can be outside of the grid by at most
+// the size of the grid; the ghost cells are given by the boundary
+// policies.
+template <typename B, typename T>
+accumulation_t<T> boundary_sample(
+    const FieldState<T> &state,
+    const WaveParameters &parameters,
+    const int x,
+    const int y
+)
+{
+    const int size_x = state.amp.get_size().x;
+    const int size_y = state.amp.get_size().y;
+    const bool x_inside = 0 <= x && x < size_x;
+    const bool y_inside = 0 <= y && y < size_y;
+
+    if (!x_inside)
+    {
+        const int edge = (x < 0) ? 0 : (size_x - 1);
+        const int stride = (x < 0) ? 1 : -1;
+        const int depth = (x < 0) ? -x : (x - edge);
+        const float h_over_c = parameters.dx / parameters.c;
+
+        if (y_inside)
+        {
+            const std::ptrdiff_t i =
+                static_cast<std::ptrdiff_t>(y) * size_x + edge;
+            const EdgeLine<T> line{
+                state.amp.data() + i,
+                state.vel.data() + i,
+                stride,
+                size_x,
+                h_over_c
+            };
+            return (x < 0) ? B::x_min::ghost(line, depth)
+                           : B::x_max::ghost(line, depth);
+        }
+
+        const GhostRow<B, T> line{
+            &state, &parameters, edge, stride, y, size_x, h_over_c
+        };
+        return (x < 0) ? B::x_min::ghost(line, depth)
+                       : B::x_max::ghost(line, depth);
+    }
+
+    if (!y_inside)
+    {
+        const int edge = (y < 0) ? 0 : (size_y - 1);
+        const int stride = (y < 0) ? size_x : -size_x;
+        const int depth = (y < 0) ? -y : (y - edge);
+        const std::ptrdiff_t i =
+            static_cast<std::ptrdiff_t>(edge) * size_x + x;
+        const EdgeLine<T> line{
+            state.amp.data() + i,
+            state.vel.data() + i,
+            stride,
+            size_y,
+            parameters.dy / parameters.c
+        };
+        return (y < 0) ? B::y_min::ghost(line, depth)
+                       : B::y_max::ghost(line, depth);
+    }
+
+    return state.amp.data()[y * size_x + x];
+}
+
+template <typename B, typename S, typename T>
+accumulation_t<T> boundary_acceleration(
+    const FieldState<T> &state,
+    const WaveParameters &parameters,
+    const LaplacianScales<accumulation_t<T>> &scales,
+    const int x,
+    const int y
+)
+{
+    return laplacian<S>(
+        [&](const int i, const int j)
+        { return boundary_sample<B>(state, parameters, x + i, y + j); },
+        scales
+    );
+}
+
+// Region where the acceleration can be nonzero; the cells outside of
+// the region of the amplitude and the velocity are zero, and the
+// stencil reaches its radius further. Periodic boundaries wrap the
+// region to the other side of the grid.
+template <typename B, typename S = SecondOrder, typename T>
+Region acceleration_region(const FieldState<T> &state)
+{
+    const glm::ivec2 size(state.amp.get_size());
+    Region region = state.amp.get_region()
+                        .unite(state.vel.get_region())
+                        .dilate(S::radius);
+    if (region.empty())
+        return region;
+
+    constexpr bool periodic_x = std::is_same_v<typename B::x_min, Periodic> ||
+                                std::is_same_v<typename B::x_max, Periodic>;
+    constexpr bool periodic_y = std::is_same_v<typename B::y_min, Periodic> ||
+                                std::is_same_v<typename B::y_max, Periodic>;
+    if (periodic_x && (region.min.x < 0 || region.max.x > size.x))
+    {
+        region.min.x = 0;
+        region.max.x = size.x;
+    }
+    if (periodic_y && (region.min.y < 0 || region.max.y > size.y))
+    {
+        region.min.y = 0;
+        region.max.y = size.y;
+    }
+    region.min =
+        glm::ivec2(std::max(region.min.x, 0), std::max(region.min.y, 0));
+    region.max = glm::ivec2(
+        std::min(region.max.x, size.x), std::min(region.max.y, size.y)
+    );
+    return region;
+}
+
+// Calculates the acceleration of the wave equation with the Laplacian
+// stencil `S` into the zero initialized `acc`. The interior cells are
+// updated without any branching, the boundary conditions are only
+// evaluated in the bands of edge cells as wide as the radius of the
+// stencil. Only the cells inside of the acceleration region are
+// processed, so the quiescent parts of the grid are skipped. The sums
+// are carried out in the accumulation type of the field.
+template <typename B, typename S = SecondOrder, typename T>
+void wave_acceleration(
+    const FieldState<T> &state, const WaveParameters &parameters, Field<T> &acc
+)
+{
+    const int size_x = state.amp.get_size().x;
+    const int size_y = state.amp.get_size().y;
+    const int r = S::radius;
+
+    const Region region = acceleration_region<B, S>(state);
+    acc.set_region(region);
+    if (region.empty())
+        return;
+
+    using A = accumulation_t<T>;
+    const LaplacianScales<A> scales(parameters);
+
+    const int x_begin = std::max(region.min.x, r);
+    const int x_end = std::min(region.max.x, size_x - r);
+    const int y_begin = std::max(region.min.y, r);
+    const int y_end = std::min(region.max.y, size_y - r);
+
+    // Interior, the rows are split between the workers.
+    parallel_rows(
+        acc,
+        Region{glm::ivec2(x_begin, y_begin), glm::ivec2(x_end, y_end)},
+        [&](const int rows_begin, const int rows_end)
+        {
+            // Local copies, the stores cannot alias them.
+            const LaplacianScales<A> local_scales = scales;
+            const int begin = x_begin;
+            const int end = x_end;
+            for (int y = rows_begin; y < rows_end; ++y)
+            {
+                const T *amp = state.amp.data() + y * size_x;
+                T *acc_row = acc.data() + y * size_x;
+                for (int x = begin; x < end; ++x)
+                {
+                    acc_row[x] = T(laplacian<S>(
+                        [&](const int i, const int j)
+                        { return static_cast<A>(amp[j * size_x + x + i]); },
+                        local_scales
+                    ));
+                }
+            }
+        }
+    );
+
+    // Edges; the bands of rows include the corners.
+    const int bottom_end = std::min(r, size_y);
+    const int top_begin = std::max(size_y - r, bottom_end);
+    for (const auto &[begin, end] :
+         {std::make_pair(0, bottom_end), std::make_pair(top_begin, size_y)})
+    {
+        for (int y = std::max(begin, region.min.y);
+             y < std::min(end, region.max.y);
+             ++y)
+        {
+            for (int x = region.min.x; x < region.max.x; ++x)
+            {
+                acc(x, y) = T(boundary_acceleration<B, S>(
+                    state, parameters, scales, x, y
+                ));
+            }
+        }
+    }
+    const int left_end = std::min(r, size_x);
+    const int right_begin = std::max(size_x - r, left_end);
+    for (const auto &[begin, end] :
+         {std::make_pair(0, left_end), std::make_pair(right_begin, size_x)})
+    {
+        for (int y = y_begin; y < y_end; ++y)
+        {
+            for (int x = std::max(begin, region.min.x);
+                 x < std::min(end, region.max.x);
+                 ++x)
+            {
+                acc(x, y) = T(boundary_acceleration<B, S>(
+                    state, parameters, scales, x, y
+                ));
+            }
+        }
+    }
+}
+
+template <typename B, typename S = SecondOrder, typename T>
+FieldState<T>
+    wave_iteration(const FieldState<T> &state, const WaveParameters &parameters)
+{
+    Field<T> acc(state.amp.get_size());
+    wave_acceleration<B, S>(state, parameters, acc);
+    return FieldState<T>(state.vel, acc);
+}
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef SIMULATION_VISUALIZATIONS_WAVE_SOLVER3_HPP
+#define SIMULATION_VISUALIZATIONS_WAVE_SOLVER3_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <field3.hpp>
+#include <utility>
+#include <wave_solver.hpp>
+
+struct WaveParameters3
+{
+    float c;
+    float dx;
+    float dy;
+    float dz;
+};
+
+// Coefficients of the Laplacian multiplied by the square
+// of the wave speed, in the accumulation type A.
+template <typename A>
+struct LaplacianScales3
+{
+    LaplacianScales3(const WaveParameters3 &parameters)
+        : x(A(parameters.c) * A(parameters.c) /
+            (A(parameters.dx) * A(parameters.dx))),
+          y(A(parameters.c) * A(parameters.c) /
+            (A(parameters.dy) * A(parameters.dy))),
+          z(A(parameters.c) * A(parameters.c) /
+            (A(parameters.dz) * A(parameters.dz)))
+    {}
+
+    A x;
+    A y;
+    A z;
+};
+
+// Evaluates the axis aligned stencil `S` along the three axes, the
+// second order stencil is the seven point one; `amp(i, j, k)` is
+// the amplitude at the offset (i, j, k) from the cell.
+template <typename S, typename A, typename Sample>
+A laplacian3(const Sample &amp, const LaplacianScales3<A> &scales)
+{
+    static_assert(!S::isotropic, "Only the axis aligned stencils are 3D.");
+
+    A result =
+        A(S::weights[0]) * (scales.x + scales.y + scales.z) * amp(0, 0, 0);
+    for (int j = 1; j <= S::radius; ++j)
+    {
+        result += A(S::weights[j]) *
+                  (scales.x * (amp(-j, 0, 0) + amp(j, 0, 0)) +
+                   scales.y * (amp(0, -j, 0) + amp(0, j, 0)) +
+                   scales.z * (amp(0, 0, -j) + amp(0, 0, j)));
+    }
+    return result;
+}
+
+// Number of rows of the tiles of `wave_acceleration3`, so that the
+// planes of the tile touched by the stencil stay in the cache.
+template <typename S, typename T>
+int tile_rows(const glm::uvec3 size)
+{
+    const size_t cache_size = 256 << 10;
+    const size_t row_bytes = (2 * S::radius + 1) * size.x * sizeof(T);
+    return std::clamp<int>(cache_size / row_bytes, 1, size.y);
+}
+
+// Acceleration of one row of the grid; `y_rows[r + j]` and
+// `z_rows[r + j]` are the rows offset by `j` along y and z. Only the
+// cells at the ends of the row wrap around.
+template <typename S, typename T, typename A, typename Rows>
+void acceleration_row3(
+    const Rows &y_rows,
+    const Rows &z_rows,
+    T *acc_row,
+    const int size_x,
+    const LaplacianScales3<A> &scales
+)
+{
+    const int r = S::radius;
+    const T *row = y_rows[r];
+    for (int x = r; x < size_x - r; ++x)
+    {
+        acc_row[x] = T(laplacian3<S>(
+            [&](const int i, const int j, const int k)
+            {
+                if (j != 0)
+                    return static_cast<A>(y_rows[r + j][x]);
+                if (k != 0)
+                    return static_cast<A>(z_rows[r + k][x]);
+                return static_cast<A>(row[x + i]);
+            },
+            scales
+        ));
+    }
+
+    const int left_end = std::min(r, size_x);
+    const int right_begin = std::max(size_x - r, left_end);
+    for (const auto &[begin, end] :
+         {std::make_pair(0, left_end), std::make_pair(right_begin, size_x)})
+    {
+        for (int x = begin; x < end; ++x)
+        {
+            acc_row[x] = T(laplacian3<S>(
+                [&](const int i, const int j, const int k)
+                {
+                    if (j != 0)
+                        return static_cast<A>(y_rows[r + j][x]);
+                    if (k != 0)
+                        return static_cast<A>(z_rows[r + k][x]);
+                    const int wrapped = ((x + i) % size_x + size_x) % size_x;
+                    return static_cast<A>(row[wrapped]);
+                },
+                scales
+            ));
+        }
+    }
+}
+
+// Calculates the acceleration of the wave equation on a periodic grid
+// with the Laplacian stencil `S` into `acc`. The planes are split
+// between the workers; each of them sweeps its planes in tiles of rows,
+// so the rows of the neighbouring planes are still cached when the
+// stencil reaches them again. The neighbouring rows of a row are found
+// once, the cells only wrap around at the ends of the rows.
+template <typename S = SecondOrder, typename T>
+void wave_acceleration3(
+    const FieldState3<T> &state,
+    const WaveParameters3 &parameters,
+    Field3<T> &acc
+)
+{
+    using A = accumulation_t<T>;
+    const int r = S::radius;
+    const glm::ivec3 size(state.amp.get_size());
+    const LaplacianScales3<A> scales(parameters);
+    const int tile = tile_rows<S, T>(state.amp.get_size());
+
+    parallel_planes(
+        acc,
+        [&](const size_t planes_begin, const size_t planes_end)
+        {
+            // Local copies, the stores cannot alias them.
+            const LaplacianScales3<A> local_scales = scales;
+            const int z_begin = planes_begin;
+            const int z_end = planes_end;
+            std::array<const T *, 2 * r + 1> y_rows;
+            std::array<const T *, 2 * r + 1> z_rows;
+
+            for (int y_begin = 0; y_begin < size.y; y_begin += tile)
+            {
+                const int y_end = std::min(y_begin + tile, size.y);
+                for (int z = z_begin; z < z_end; ++z)
+                {
+                    for (int y = y_begin; y < y_end; ++y)
+                    {
+                        for (int j = -r; j <= r; ++j)
+                        {
+                            y_rows[r + j] =
+                                state.amp.data() + state.amp.index(0, y + j, z);
+                            z_rows[r + j] =
+                                state.amp.data() + state.amp.index(0, y, z + j);
+                        }
+                        acceleration_row3<S>(
+                            y_rows,
+                            z_rows,
+                            acc.data() + acc.index(0, y, z),
+                            size.x,
+                            local_scales
+                        );
+                    }
+                }
+            }
+        }
+    );
+}
+
+template <typename S = SecondOrder, typename T>
+FieldState3<T> wave_iteration3(
+    const FieldState3<T> &state, const WaveParameters3 &parameters
+)
+{
+    Field3<T> acc(state.amp.get_size());
+    wave_acceleration3<S>(state, parameters, acc);
+    return FieldState3<T>(state.vel, acc);
+}
+
+#endif
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <workers.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+
+// Whether the current thread is a worker; tasks started by the
+// workers run on the same thread instead of waiting for the pool.
+thread_local bool is_worker = false;
+
+// Whether the process was forked after starting the workers; only
+// the forking thread exists in the child process, which then
+// processes the tasks itself.
+bool forked = false;
+
+void pin_thread(std::thread &thread, const unsigned index)
+{
+#ifdef __linux__
+    // The index-th processor the process is allowed to run on.
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return;
+    const int count = CPU_COUNT(&allowed);
+    if (count == 0)
+        return;
+
+    int skip = index % count;
+    for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, &allowed) || skip-- != 0)
+            continue;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+        return;
+    }
+#else
+    static_cast<void>(thread);
+    static_cast<void>(index);
+#endif
+}
+
+}
+
+void Workers::configure(const unsigned count, const bool pin)
+{
+    Workers::settings() = std::make_pair(count, pin);
+}
+
+Workers &Workers::get()
+{
+    static Workers workers(
+        Workers::settings().first, Workers::settings().second
+    );
+    return workers;
+}
+
+Workers::Workers(const unsigned count, const bool pin)
+    : task(nullptr), rows(0), generation(0), remaining(0), stop(false)
+{
+#ifdef __linux__
+    pthread_atfork(nullptr, nullptr, []() { forked = true; });
+#endif
+    const unsigned threads =
+        std::max(count ? count : std::thread::hardware_concurrency(), 1u);
+    for (unsigned i = 0; i != threads; ++i)
+    {
+        this->threads.emplace_back([this, i]() { this->work(i); });
+        if (pin)
+            pin_thread(this->threads.back(), i);
+    }
+}
+
+Workers::~Workers()
+{
+    {
+        std::lock_guard lock(this->mutex);
+        this->stop = true;
+    }
+    this->task_ready.notify_all();
+    for (std::thread &thread : this->threads)
+        thread.join();
+}
+
+std::pair<size_t, size_t>
+    Workers::partition(const unsigned index, const size_t rows) const
+{
+    const size_t count = this->threads.size();
+    return std::make_pair(rows * index / count, rows * (index + 1) / count);
+}
+
+void Workers::run(
+    const size_t rows,
+    const size_t row_size,
+    const std::function<void(size_t, size_t)> &task,
+    const size_t min_cells
+)
+{
+    if (rows * row_size < min_cells || this->threads.size() == 1 ||
+        is_worker || forked)
+    {
+        task(0, rows);
+        return;
+    }
+
+    // One task at a time; the calling threads take turns.
+    std::lock_guard run_lock(this->run_mutex);
+
+    std::unique_lock lock(this->mutex);
+    this->task = &task;
+    this->rows = rows;
+    this->remaining = this->threads.size();
+    ++this->generation;
+    this->task_ready.notify_all();
+    this->task_done.wait(lock, [this]() { return this->remaining == 0; });
+    this->task = nullptr;
+}
+
+void Workers::work(const unsigned index)
+{
+    is_worker = true;
+    size_t generation = 0;
+    while (true)
+    {
+        const std::function<void(size_t, size_t)> *task;
+        size_t rows;
+        {
+            std::unique_lock lock(this->mutex);
+            this->task_ready.wait(
+                lock,
+                [&]() { return this->stop || this->generation != generation; }
+            );
+            if (this->stop)
+                return;
+            generation = this->generation;
+            task = this->task;
+            rows = this->rows;
+        }
+
+        const auto [begin, end] = this->partition(index, rows);
+        if (begin != end)
+            (*task)(begin, end);
+
+        {
+            std::lock_guard lock(this->mutex);
+            if (--this->remaining == 0)
+                this->task_done.notify_one();
+        }
+    }
+}
+
+std::pair<unsigned, bool> &Workers::settings()
+{
+    static std::pair<unsigned, bool> settings(0, false);
+    return settings;
+}
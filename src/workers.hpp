@@ -0,0 +1,77 @@
+#ifndef SIMULATION_VISUALIZATIONS_WORKERS_HPP
+#define SIMULATION_VISUALIZATIONS_WORKERS_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Pool of worker threads processing the rows of the grids in
+// parallel. The rows are always split into the same contiguous
+// ranges, one per worker, so a worker touches the same memory in
+// every pass. Memory pages are placed on the NUMA node of the thread
+// which touches them first, so the buffers of the fields are
+// initialized with the same partitioning, see Buffer.
+class Workers
+{
+public:
+
+    // Sets the number of workers and whether each of them is pinned to
+    // its own processor; only takes effect before the first call of
+    // `get`. By default there is one unpinned worker per processor.
+    static void configure(const unsigned count, const bool pin);
+
+    static Workers &get();
+
+    ~Workers();
+
+    Workers(const Workers &) = delete;
+    Workers &operator=(const Workers &) = delete;
+
+    unsigned get_count() const
+    {
+        return this->threads.size();
+    }
+
+    // Range of the `rows` processed by the worker `index`.
+    std::pair<size_t, size_t> partition(
+        const unsigned index, const size_t rows
+    ) const;
+
+    // Calls `task` with the range of rows of every worker, in parallel,
+    // and waits for all of them. Small grids of less than `min_cells`
+    // cells, tasks started by the workers themselves, and tasks of
+    // processes forked after starting the workers are processed on
+    // the calling thread.
+    void run(
+        const size_t rows,
+        const size_t row_size,
+        const std::function<void(size_t, size_t)> &task,
+        const size_t min_cells = 1 << 16
+    );
+
+private:
+
+    Workers(const unsigned count, const bool pin);
+
+    void work(const unsigned index);
+
+    static std::pair<unsigned, bool> &settings();
+
+    std::vector<std::thread> threads;
+    std::mutex run_mutex;
+    std::mutex mutex;
+    std::condition_variable task_ready;
+    std::condition_variable task_done;
+    const std::function<void(size_t, size_t)> *task;
+    size_t rows;
+    // Incremented for every task, the workers wait for a new one.
+    size_t generation;
+    unsigned remaining;
+    bool stop;
+};
+
+#endif